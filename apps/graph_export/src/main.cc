@@ -0,0 +1,67 @@
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include "routing_api.h"
+#include "parsers/binary/graph_file.h"
+#include "impl/graph_order.h"
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char**argv) {
+    using namespace routing;
+
+    if (argc < 3) {
+        std::cout << "Usage: ./build/bin/graph_export /path/to/graph /path/to/output"
+                  << GraphFile::kExtension << " [file|hilbert|bfs]" << std::endl;
+        return 0;
+    }
+
+    // the file keeps the node order it is written in
+    RoutingAPI api;
+    const std::string order = argc > 3 ? argv[3] : "file";
+    if (order == "hilbert") {
+        api.SetNodeOrder(NodeOrder::kHilbert);
+    } else if (order == "bfs") {
+        api.SetNodeOrder(NodeOrder::kBreadthFirst);
+    } else if (order != "file") {
+        std::cout << "Unknown node order " << order << std::endl;
+        return 1;
+    }
+    auto start = std::chrono::steady_clock::now();
+    IGraph* graph = api.LoadFromFile(argv[1]);
+    if (!graph || !graph->GetCompactGraph()) {
+        std::cout << "Unable to parse graph file." << std::endl;
+        delete graph;
+        return 1;
+    }
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    std::cout << "Loaded " << argv[1] << " (" << compact.NumNodes() << " nodes, "
+              << compact.NumEdges() << " edges) in " << millisecondsSince(start) << " ms, "
+              << order << " order, mean edge span " << GraphOrder::MeanEdgeSpan(compact) << std::endl;
+
+    try {
+        GraphFile::Write(compact, argv[2]);
+
+        // read it back the way the applications will
+        start = std::chrono::steady_clock::now();
+        CompactGraph* mapped = GraphFile::Map(argv[2]);
+        std::cout << "Mapped " << argv[2] << " in " << millisecondsSince(start) << " ms" << std::endl;
+        bool same = mapped->NumNodes() == compact.NumNodes() && mapped->NumEdges() == compact.NumEdges();
+        delete mapped;
+        if (!same) {
+            std::cout << "Written graph does not match the input." << std::endl;
+            delete graph;
+            return 1;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+        delete graph;
+        return 1;
+    }
+
+    delete graph;
+
+    return 0;
+}
@@ -44,16 +44,22 @@ int main(int argc, char**argv) {
     Image output(resolution,resolution*aspectRatio);
     output.Clear(Color(0,0,0,1));
 
+    // same mapping as bb.Normalize(), without a vector per node
+    auto pixel = [&](const Point3& pos, int axis, int size) {
+        float diff = bb.max[axis] - bb.min[axis];
+        return diff < 0.00001 ? 0 : int((pos[axis] - bb.min[axis])/diff*size);
+    };
+
     const std::vector<IGraphNode*>& nodes = graph->GetNodes();
     for (int i = 0; i < nodes.size(); i++) {
-        std::vector<float> normalizedPoint = bb.Normalize(nodes[i]->GetPosition());
+        Point3 pos = nodes[i]->GetPoint();
+        int startX = pixel(pos, 0, output.GetWidth());
+        int startY = pixel(pos, 2, output.GetHeight());
         const std::vector<IGraphNode*>& neighbors = nodes[i]->GetNeighbors();
         for (int j = 0; j < neighbors.size(); j++) {
-            std::vector<float> neighborPos = bb.Normalize(neighbors[j]->GetPosition());
-            int startX = normalizedPoint[0]*output.GetWidth();
-            int startY = normalizedPoint[2]*output.GetHeight();
-            int endX = neighborPos[0]*output.GetWidth();
-            int endY = neighborPos[2]*output.GetHeight();
+            Point3 neighborPos = neighbors[j]->GetPoint();
+            int endX = pixel(neighborPos, 0, output.GetWidth());
+            int endY = pixel(neighborPos, 2, output.GetHeight());
             output.DrawLine(startX, startY, endX, endY, Color(0.5,0.5,1,1));
         }
     }
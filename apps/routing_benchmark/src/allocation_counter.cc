@@ -0,0 +1,34 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include "benchmarks.h"
+
+// Replaces the global allocation functions of the benchmark binary so the
+// benchmarks can count allocations, including the library's. The arrays
+// and aligned variants forward to these or keep their defaults.
+
+namespace {
+
+std::atomic<uint64_t> allocations(0);
+
+}
+
+uint64_t AllocationCount() {
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void* operator new(std::size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size > 0 ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
@@ -0,0 +1,68 @@
+#include <future>
+#include <iostream>
+#include <thread>
+#include "benchmarks.h"
+#include "routing_api.h"
+#include "routing/astar.h"
+
+using namespace routing;
+
+// Queries per second of A* trips between random points, one after another
+// on this thread and as batches on 1, 2, 4 and 8 threads.
+int BatchBenchmark(IGraph* graph) {
+    const int queries = 2000;
+    std::vector<std::vector<float> > points = RandomPoints(graph, 2 * queries, 9);
+    std::vector<PathRequest> requests;
+    for (int i = 0; i < queries; i++) {
+        requests.push_back({points[2*i], points[2*i+1], &AStar::Default()});
+    }
+    std::cout << queries << " A* queries, " << std::thread::hardware_concurrency()
+              << " hardware threads" << std::endl;
+
+    // warm up the compact graph and this thread's search workspace
+    graph->GetSharedPath(points[0], points[1], AStar::Default());
+
+    std::vector<SharedPath> reference;
+    Stopwatch serialTime;
+    for (const PathRequest& request : requests) {
+        reference.push_back(graph->GetSharedPath(request.src, request.dest, *request.strategy));
+    }
+    const double serialMs = serialTime.ElapsedMs();
+    std::cout << "  serial:    " << queries * 1000.0 / serialMs << " queries/s" << std::endl;
+
+    int mismatches = 0;
+    auto check = [&](const std::vector<SharedPath>& paths) {
+        for (int i = 0; i < queries; i++) {
+            if (!paths[i] || *paths[i] != *reference[i]) {
+                mismatches++;
+            }
+        }
+    };
+
+    RoutingAPI api;
+    for (unsigned threads : {1, 2, 4, 8}) {
+        api.SetThreads(threads);
+        // first batch starts the threads and sizes their workspaces
+        api.GetPaths(graph, std::vector<PathRequest>(requests.begin(), requests.begin() + threads));
+
+        Stopwatch batchTime;
+        std::vector<SharedPath> paths = api.GetPaths(graph, requests);
+        const double batchMs = batchTime.ElapsedMs();
+        check(paths);
+
+        Stopwatch submitTime;
+        std::vector<std::future<SharedPath> > futures = api.SubmitPaths(graph, requests);
+        paths.clear();
+        for (std::future<SharedPath>& future : futures) {
+            paths.push_back(future.get());
+        }
+        const double submitMs = submitTime.ElapsedMs();
+        check(paths);
+
+        std::cout << "  " << threads << " threads: " << queries * 1000.0 / batchMs << " queries/s ("
+                  << serialMs / batchMs << "x), futures " << queries * 1000.0 / submitMs
+                  << " queries/s" << std::endl;
+    }
+    std::cout << "  mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
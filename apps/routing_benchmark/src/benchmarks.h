@@ -0,0 +1,119 @@
+#ifndef ROUTING_BENCHMARKS_H_
+#define ROUTING_BENCHMARKS_H_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "impl/compact_graph.h"
+
+// Every benchmark gets the loaded graph and prints its own report.
+typedef int (*Benchmark)(routing::IGraph* graph);
+
+int NearestNodeBenchmark(routing::IGraph* graph);
+int BidirectionalBenchmark(routing::IGraph* graph);
+int ContractionBenchmark(routing::IGraph* graph);
+int LandmarkBenchmark(routing::IGraph* graph);
+int RouteCacheBenchmark(routing::IGraph* graph);
+int DistanceMatrixBenchmark(routing::IGraph* graph);
+int ShortestPathTreeBenchmark(routing::IGraph* graph);
+int DistanceBenchmark(routing::IGraph* graph);
+int BatchBenchmark(routing::IGraph* graph);
+int OverlayBenchmark(routing::IGraph* graph);
+int ClosureBenchmark(routing::IGraph* graph);
+int NodeOrderBenchmark(routing::IGraph* graph);
+int BudgetBenchmark(routing::IGraph* graph);
+
+// Benchmarks of loading itself get the file name instead.
+typedef int (*FileBenchmark)(const std::string& file);
+
+int OsmLoadBenchmark(const std::string& file);
+int ObjLoadBenchmark(const std::string& file);
+
+// Benchmarks that also write a machine readable report get its path.
+typedef int (*ReportBenchmark)(routing::IGraph* graph, const std::string& report);
+
+int SuiteBenchmark(routing::IGraph* graph, const std::string& report);
+
+// Number of operator new calls in the process so far, see
+// allocation_counter.cc. Take the difference around the code to measure.
+uint64_t AllocationCount();
+
+// Milliseconds since construction.
+class Stopwatch {
+public:
+    Stopwatch() : start(std::chrono::steady_clock::now()) {}
+    double ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Same names, positions and adjacency in the same order.
+inline bool SameGraph(const routing::CompactGraph& a, const routing::CompactGraph& b) {
+    const routing::CompactGraphArrays x = a.Arrays();
+    const routing::CompactGraphArrays y = b.Arrays();
+    if (x.numNodes != y.numNodes || x.numEdges != y.numEdges) {
+        return false;
+    }
+    for (uint32_t node = 0; node < x.numNodes; node++) {
+        if (a.NameOf(node) != b.NameOf(node)) {
+            return false;
+        }
+    }
+    return std::equal(x.positions, x.positions + 3 * x.numNodes, y.positions) &&
+           std::equal(x.offsets, x.offsets + x.numNodes + 1, y.offsets) &&
+           std::equal(x.targets, x.targets + x.numEdges, y.targets);
+}
+
+// Reproducible points spread uniformly over the bounding box of the graph.
+inline std::vector<std::vector<float> > RandomPoints(const routing::IGraph* graph, int count, unsigned seed) {
+    routing::BoundingBox bb = graph->GetBoundingBox();
+    std::mt19937 rng(seed);
+    std::vector<std::vector<float> > points;
+    for (int i = 0; i < count; i++) {
+        std::vector<float> point;
+        for (size_t j = 0; j < bb.min.size(); j++) {
+            point.push_back(std::uniform_real_distribution<float>(bb.min[j], bb.max[j])(rng));
+        }
+        points.push_back(point);
+    }
+    return points;
+}
+
+// Node pairs at least half the bounding box diagonal apart, the long trips
+// where search strategies differ the most.
+inline std::vector<std::pair<std::string, std::string> > CrossCampusQueries(const routing::IGraph* graph,
+                                                                           int count, unsigned seed) {
+    routing::BoundingBox bb = graph->GetBoundingBox();
+    const float crossCampus = 0.5f * std::sqrt(
+        (bb.max[0]-bb.min[0])*(bb.max[0]-bb.min[0]) + (bb.max[2]-bb.min[2])*(bb.max[2]-bb.min[2]));
+
+    std::vector<std::vector<float> > points = RandomPoints(graph, 10 * count, seed);
+    std::vector<std::pair<std::string, std::string> > queries;
+    for (size_t i = 0; i + 1 < points.size() && queries.size() < size_t(count); i += 2) {
+        const routing::IGraphNode* a = graph->NearestNode(points[i], routing::EuclideanDistance());
+        const routing::IGraphNode* b = graph->NearestNode(points[i+1], routing::EuclideanDistance());
+        if (a->GetPoint().distanceBetween(b->GetPoint()) >= crossCampus) {
+            queries.push_back({a->GetName(), b->GetName()});
+        }
+    }
+    return queries;
+}
+
+// Sum of the euclidean edge lengths along a path of node names.
+inline float PathLength(const routing::IGraph* graph, const std::vector<std::string>& path) {
+    float length = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+        length += graph->GetNode(path[i-1])->GetPoint().distanceBetween(graph->GetNode(path[i])->GetPoint());
+    }
+    return length;
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include <iostream>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/bidirectional.h"
+#include "routing/dijkstra.h"
+#include "routing/search_engine.h"
+
+using namespace routing;
+
+// Settled nodes of the last query on this thread. Only bidirectional
+// searches use the second workspace, otherwise it holds a stale count.
+static uint32_t lastSettled(bool bidirectional) {
+    return SearchWorkspace::ForCurrentThread(0).SettledCount() +
+           (bidirectional ? SearchWorkspace::ForCurrentThread(1).SettledCount() : 0);
+}
+
+int BidirectionalBenchmark(IGraph* graph) {
+    // long trips only: endpoints at least half the bounding box diagonal apart
+    std::vector<std::pair<std::string, std::string> > queries = CrossCampusQueries(graph, 200, 7);
+
+    const RoutingStrategy* strategies[] = {
+        &Dijkstra::Instance(), &BidirectionalDijkstra::Instance(),
+        &AStar::Default(), &BidirectionalSearch::Default()};
+    const char* names[] = {"dijkstra", "bidirectional dijkstra", "astar", "bidirectional astar"};
+
+    std::cout << queries.size() << " cross campus queries" << std::endl;
+    std::vector<float> reference;
+    int mismatches = 0;
+    for (int s = 0; s < 4; s++) {
+        uint64_t settled = 0;
+        std::vector<std::vector<std::string> > paths;
+        Stopwatch time;
+        for (const auto& query : queries) {
+            paths.push_back(strategies[s]->GetPath(graph, query.first, query.second));
+            settled += lastSettled(s % 2 == 1);
+        }
+        double ms = time.ElapsedMs();
+
+        for (size_t q = 0; q < queries.size(); q++) {
+            float length = PathLength(graph, paths[q]);
+            if (s == 0) {
+                reference.push_back(length);
+            } else if (std::abs(length - reference[q]) > 1e-4f * (1 + reference[q])) {
+                mismatches++;
+            }
+        }
+        std::cout << "  " << names[s] << ": " << settled / double(queries.size()) << " settled/query, "
+                  << ms * 1000.0 / queries.size() << " us/query" << std::endl;
+    }
+    std::cout << "  path length mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
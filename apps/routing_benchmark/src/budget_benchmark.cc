@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/bidirectional.h"
+#include "routing/depth_first_search.h"
+#include "routing/dijkstra.h"
+
+using namespace routing;
+
+// Worst query latency of every budgeted strategy with and without a budget
+// of settled nodes and of time, over cross campus trips and trips to a node
+// whose in edges are all closed. Every partial route must start at the
+// source and follow open edges.
+int BudgetBenchmark(IGraph* graph) {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    std::vector<std::pair<std::string, std::string> > queries = CrossCampusQueries(graph, 50, 25);
+
+    // an island: every way into the target of the last trip is closed
+    const uint32_t island = compact.IndexOf(queries.back().second);
+    std::vector<std::pair<std::string, std::string> > closed;
+    for (uint32_t r = compact.ReverseEdgeBegin(island); r < compact.ReverseEdgeEnd(island); r++) {
+        closed.push_back({compact.NameOf(compact.ReverseEdgeSource(r)), compact.NameOf(island)});
+        graph->SetEdgeEnabled(closed.back().first, closed.back().second, false);
+    }
+    for (int i = 0; i < 10; i++) {
+        queries.push_back({queries[i].first, compact.NameOf(island)});
+    }
+
+    SearchBudget nodes;
+    nodes.maxSettled = compact.NumNodes() / 10;
+    SearchBudget time;
+    time.maxMilliseconds = 0.2;
+    const std::vector<std::pair<std::string, SearchBudget> > budgets = {
+        {"none", SearchBudget()},
+        {"10% nodes", nodes},
+        {"0.2 ms", time},
+    };
+    const std::vector<std::pair<std::string, const RoutingStrategy*> > strategies = {
+        {"astar", &AStar::Default()},
+        {"dijkstra", &Dijkstra::Instance()},
+        {"breadth_first", &DepthFirstSearch::Default()},
+        {"depth_first", &DepthFirstSearch::DepthFirst()},
+        {"bidirectional", &BidirectionalSearch::Default()},
+    };
+
+    int invalid = 0;
+    std::cout << queries.size() << " trips, " << closed.size() << " edges closed around the last target"
+              << std::endl;
+    for (const auto& strategy : strategies) {
+        for (const auto& budget : budgets) {
+            double worst = 0;
+            std::map<RouteStatus, int> statuses;
+            for (const auto& query : queries) {
+                Stopwatch watch;
+                RouteResult result = strategy.second->GetRoute(graph, query.first, query.second, budget.second);
+                worst = std::max(worst, watch.ElapsedMs());
+                statuses[result.status]++;
+
+                bool valid = result.status == RouteStatus::kUnreachable
+                    ? result.path.empty()
+                    : !result.path.empty() && result.path.front() == query.first;
+                for (size_t i = 1; valid && i < result.path.size(); i++) {
+                    const uint32_t edge = compact.FindEdge(result.path[i-1], result.path[i]);
+                    valid = edge != CompactGraph::kInvalidEdge && compact.EdgeOpen(edge);
+                }
+                if (result.status == RouteStatus::kFound) {
+                    valid = valid && result.path.back() == query.second;
+                }
+                invalid += valid ? 0 : 1;
+            }
+            std::cout << "  " << strategy.first << ", budget " << budget.first << ": worst " << worst << " ms, "
+                      << statuses[RouteStatus::kFound] << " found, "
+                      << statuses[RouteStatus::kUnreachable] << " unreachable, "
+                      << statuses[RouteStatus::kBudgetExceeded] << " over budget" << std::endl;
+        }
+    }
+
+    std::atomic<bool> cancel(true);
+    SearchBudget cancelled;
+    cancelled.cancel = &cancel;
+    const RouteStatus status = AStar::Default().GetRoute(graph, queries[0].first, queries[0].second,
+                                                         cancelled).status;
+    if (status != RouteStatus::kCancelled) {
+        invalid++;
+    }
+
+    for (const auto& edge : closed) {
+        graph->SetEdgeEnabled(edge.first, edge.second, true);
+    }
+    std::cout << invalid << " invalid routes" << std::endl;
+    return invalid == 0 ? 0 : 1;
+}
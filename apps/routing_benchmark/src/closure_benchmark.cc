@@ -0,0 +1,167 @@
+#include <cmath>
+#include <iostream>
+#include "benchmarks.h"
+#include "impl/compact_graph.h"
+#include "routing/astar.h"
+
+using namespace routing;
+
+// Closes streets in the middle of cached routes: how many cached routes the
+// closures drop, whether every route served afterwards avoids them and is
+// as short as a fresh search, and what repairing a route costs next to
+// routing it again. Then checks the contraction hierarchy rebuilt without
+// the closed streets and that opening them again empties the cache.
+int ClosureBenchmark(IGraph* graph) {
+    const int trips = 400;
+    const int closures = 10;
+    const RoutingStrategy& astar = AStar::Default();
+    std::vector<std::vector<float> > points = RandomPoints(graph, 2 * trips, 21);
+
+    auto length = [](const SharedPath& path) {
+        float total = 0;
+        for (size_t i = 1; i < path->size(); i++) {
+            total += Point3((*path)[i-1]).distanceBetween(Point3((*path)[i]));
+        }
+        return total;
+    };
+    auto crossesClosed = [graph](const SharedPath& path) {
+        const CompactGraph& compact = *graph->GetCompactGraph();
+        for (size_t i = 1; i < path->size(); i++) {
+            const uint32_t from = compact.GetSpatialIndex().Nearest((*path)[i-1].data());
+            const uint32_t to = compact.GetSpatialIndex().Nearest((*path)[i].data());
+            const uint32_t edge = compact.FindEdge(from, to);
+            if (from != to && edge != CompactGraph::kInvalidEdge && !compact.EdgeOpen(edge)) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    std::vector<SharedPath> before;
+    for (int i = 0; i < trips; i++) {
+        before.push_back(graph->GetSharedPath(points[2*i], points[2*i+1], astar));
+    }
+
+    // both directions of the middle edge of some of the longer routes,
+    // skipping bridges whose closure would cut the graph in two
+    std::mt19937 rng(4);
+    std::vector<std::pair<std::string, std::string> > closed;
+    while (closed.size() < closures) {
+        const std::vector<std::vector<float> >& path = *before[rng() % trips];
+        if (path.size() < 8) {
+            continue;
+        }
+        const std::string a = graph->NearestNode(path[path.size() / 2], EuclideanDistance())->GetName();
+        const std::string b = graph->NearestNode(path[path.size() / 2 + 1], EuclideanDistance())->GetName();
+        graph->SetEdgeEnabled(a, b, false);
+        graph->SetEdgeEnabled(b, a, false);
+        const bool detour = !astar.GetPath(graph, a, b).empty() && !astar.GetPath(graph, b, a).empty();
+        graph->SetEdgeEnabled(a, b, true);
+        graph->SetEdgeEnabled(b, a, true);
+        if (detour) {
+            closed.push_back({a, b});
+        }
+    }
+
+    graph->EnableRouteCache(trips);
+    before.clear();
+    for (int i = 0; i < trips; i++) {
+        before.push_back(graph->GetSharedPath(points[2*i], points[2*i+1], astar));
+    }
+    const uint64_t version = graph->GetVersion();
+    for (const auto& street : closed) {
+        graph->SetEdgeEnabled(street.first, street.second, false);
+        graph->SetEdgeEnabled(street.second, street.first, false);
+    }
+    std::cout << trips << " cached A* trips, " << closed.size() << " streets closed, version "
+              << version << " -> " << graph->GetVersion() << std::endl;
+
+    const RouteCacheStats stale = graph->GetRouteCacheStats();
+    std::vector<SharedPath> after;
+    Stopwatch afterTime;
+    for (int i = 0; i < trips; i++) {
+        after.push_back(graph->GetSharedPath(points[2*i], points[2*i+1], astar));
+    }
+    const double afterMs = afterTime.ElapsedMs();
+    const RouteCacheStats stats = graph->GetRouteCacheStats();
+    std::cout << "  cache:   " << stats.invalidations - stale.invalidations << " of " << stale.size
+              << " routes dropped, " << stats.hits - stale.hits << " hits, "
+              << afterMs << " ms for all trips" << std::endl;
+
+    // a fresh search for every trip, without the cache
+    graph->EnableRouteCache(0);
+    int mismatches = 0;
+    std::vector<int> broken;
+    std::vector<SharedPath> fresh;
+    Stopwatch recomputeTime;
+    for (int i = 0; i < trips; i++) {
+        fresh.push_back(graph->GetSharedPath(points[2*i], points[2*i+1], astar));
+    }
+    const double recomputeMs = recomputeTime.ElapsedMs();
+    for (int i = 0; i < trips; i++) {
+        if (crossesClosed(after[i]) || std::fabs(length(after[i]) - length(fresh[i])) > 1e-3f * length(fresh[i])) {
+            mismatches++;
+        }
+        if (crossesClosed(before[i])) {
+            broken.push_back(i);
+        }
+    }
+
+    std::vector<SharedPath> repaired;
+    Stopwatch repairTime;
+    for (int i : broken) {
+        repaired.push_back(graph->RepairPath(before[i], 0, version, astar));
+    }
+    const double repairMs = repairTime.ElapsedMs();
+    double stretch = 0;
+    int unreachable = 0;
+    for (size_t j = 0; j < broken.size(); j++) {
+        if (!repaired[j]) {
+            unreachable++;
+            continue;
+        }
+        if (crossesClosed(repaired[j])) {
+            mismatches++;
+        }
+        stretch += length(repaired[j]) / length(fresh[broken[j]]);
+    }
+    std::cout << "  repair:  " << broken.size() << " broken routes in " << repairMs << " ms, "
+              << "recomputing all " << trips << " takes " << recomputeMs << " ms, mean stretch "
+              << stretch / std::max<size_t>(1, broken.size() - unreachable) << ", "
+              << unreachable << " unreachable" << std::endl;
+
+    // the closures dropped the hierarchy, the matrix falls back to searches
+    std::vector<std::vector<float> > sources(points.begin(), points.begin() + 20);
+    std::vector<std::vector<float> > targets(points.begin() + 20, points.begin() + 40);
+    std::vector<std::vector<float> > searched = graph->GetDistanceMatrix(sources, targets);
+    Stopwatch hierarchyTime;
+    graph->GetCompactGraph()->GetContractionHierarchy();
+    const double hierarchyMs = hierarchyTime.ElapsedMs();
+    std::vector<std::vector<float> > contracted = graph->GetDistanceMatrix(sources, targets);
+    int hierarchyMismatches = 0;
+    for (size_t s = 0; s < sources.size(); s++) {
+        for (size_t t = 0; t < targets.size(); t++) {
+            if (std::fabs(searched[s][t] - contracted[s][t]) > 1e-3f * searched[s][t]) {
+                hierarchyMismatches++;
+            }
+        }
+    }
+    std::cout << "  hierarchy: rebuilt in " << hierarchyMs << " ms, " << hierarchyMismatches
+              << " matrix mismatches" << std::endl;
+
+    graph->EnableRouteCache(trips);
+    for (int i = 0; i < trips; i++) {
+        graph->GetSharedPath(points[2*i], points[2*i+1], astar);
+    }
+    const RouteCacheStats full = graph->GetRouteCacheStats();
+    for (const auto& street : closed) {
+        graph->SetEdgeEnabled(street.first, street.second, true);
+        graph->SetEdgeEnabled(street.second, street.first, true);
+    }
+    graph->GetSharedPath(points[0], points[1], astar);
+    std::cout << "  reopened: " << graph->GetRouteCacheStats().invalidations - full.invalidations
+              << " of " << full.size << " routes dropped" << std::endl;
+
+    std::cout << mismatches + hierarchyMismatches << " mismatches" << std::endl;
+    return mismatches + hierarchyMismatches == 0 ? 0 : 1;
+}
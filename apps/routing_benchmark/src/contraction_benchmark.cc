@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <iostream>
+#include "benchmarks.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/dijkstra.h"
+#include "routing/search_engine.h"
+
+using namespace routing;
+
+int ContractionBenchmark(IGraph* graph) {
+    const CompactGraph* compact = graph->GetCompactGraph();
+
+    Stopwatch build;
+    std::shared_ptr<const ContractionHierarchy> hierarchy(new ContractionHierarchy(*compact));
+    std::cout << "Contracted " << compact->NumNodes() << " nodes in " << build.ElapsedMs() << " ms, "
+              << hierarchy->NumShortcuts() << " shortcuts" << std::endl;
+
+    const std::string file = "build/contraction_benchmark.ch";
+    Stopwatch save;
+    hierarchy->Save(file);
+    std::cout << "Saved in " << save.ElapsedMs() << " ms" << std::endl;
+    Stopwatch load;
+    hierarchy.reset(ContractionHierarchy::Load(file, *compact));
+    std::cout << "Loaded in " << load.ElapsedMs() << " ms" << std::endl;
+    std::remove(file.c_str());
+    compact->SetContractionHierarchy(hierarchy);
+
+    std::vector<std::vector<float> > points = RandomPoints(graph, 2000, 11);
+    std::vector<std::pair<std::string, std::string> > queries;
+    for (size_t i = 0; i + 1 < points.size(); i += 2) {
+        queries.push_back({graph->NearestNode(points[i], EuclideanDistance())->GetName(),
+                           graph->NearestNode(points[i+1], EuclideanDistance())->GetName()});
+    }
+
+    const RoutingStrategy* strategies[] = {&Dijkstra::Instance(), &ContractionHierarchies::Default()};
+    const char* names[] = {"dijkstra", "contraction hierarchies"};
+    std::cout << queries.size() << " random queries" << std::endl;
+    std::vector<float> reference;
+    int mismatches = 0;
+    for (int s = 0; s < 2; s++) {
+        uint64_t settled = 0;
+        std::vector<std::vector<std::string> > paths;
+        Stopwatch time;
+        for (const auto& query : queries) {
+            paths.push_back(strategies[s]->GetPath(graph, query.first, query.second));
+            settled += SearchWorkspace::ForCurrentThread(0).SettledCount() +
+                       (s == 1 ? SearchWorkspace::ForCurrentThread(1).SettledCount() : 0);
+        }
+        double ms = time.ElapsedMs();
+
+        for (size_t q = 0; q < queries.size(); q++) {
+            float length = PathLength(graph, paths[q]);
+            if (s == 0) {
+                reference.push_back(length);
+            } else if (std::abs(length - reference[q]) > 1e-4f * (1 + reference[q])) {
+                mismatches++;
+            }
+        }
+        std::cout << "  " << names[s] << ": " << settled / double(queries.size()) << " settled/query, "
+                  << ms * 1000.0 / queries.size() << " us/query" << std::endl;
+    }
+
+    // the same queries without the node name lookups and conversions
+    std::vector<std::pair<uint32_t, uint32_t> > indices;
+    for (const auto& query : queries) {
+        indices.push_back({compact->IndexOf(query.first), compact->IndexOf(query.second)});
+    }
+    std::vector<uint32_t> path;
+    Stopwatch time;
+    for (const auto& query : indices) {
+        hierarchy->ShortestPath(query.first, query.second, path);
+    }
+    std::cout << "  contraction hierarchies by index: " << time.ElapsedMs() * 1000.0 / queries.size()
+              << " us/query" << std::endl;
+    std::cout << "  path length mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <memory>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/search_engine.h"
+#include "routing/static_astar.h"
+
+using namespace routing;
+
+// A euclidean distance the search engine does not recognize, so every
+// relaxation goes through the virtual interface like any user metric.
+class OpaqueEuclidean : public EuclideanDistance {};
+
+// Cost of one distance evaluation through the old vector interface, the
+// virtual pointer interface and an inlined policy, then of whole searches
+// that evaluate the cost and heuristic once per relaxation.
+int DistanceBenchmark(IGraph* graph) {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    const uint32_t n = compact.NumNodes();
+    const int calls = 2000000;
+
+    std::unique_ptr<DistanceFunction> virtualEuclidean(new OpaqueEuclidean());
+    const DistanceFunction& function = *virtualEuclidean;
+    double sums[3] = {0, 0, 0};
+    double ms[3];
+    {
+        Stopwatch watch;
+        for (int i = 0; i < calls; i++) {
+            const float* a = compact.Position(i % n);
+            const float* b = compact.Position((i * 7919u) % n);
+            sums[0] += function.Calculate(std::vector<float>(a, a + 3), std::vector<float>(b, b + 3));
+        }
+        ms[0] = watch.ElapsedMs();
+    }
+    {
+        Stopwatch watch;
+        for (int i = 0; i < calls; i++) {
+            sums[1] += function.Calculate(compact.Position(i % n), compact.Position((i * 7919u) % n));
+        }
+        ms[1] = watch.ElapsedMs();
+    }
+    {
+        Stopwatch watch;
+        for (int i = 0; i < calls; i++) {
+            sums[2] += EuclideanPolicy::Between(compact.Position(i % n), compact.Position((i * 7919u) % n));
+        }
+        ms[2] = watch.ElapsedMs();
+    }
+    std::cout << calls << " distance evaluations" << std::endl;
+    std::cout << "  virtual, vectors:  " << 1e6 * ms[0] / calls << " ns/call" << std::endl;
+    std::cout << "  virtual, pointers: " << 1e6 * ms[1] / calls << " ns/call" << std::endl;
+    std::cout << "  inlined policy:    " << 1e6 * ms[2] / calls << " ns/call" << std::endl;
+    int mismatches = (sums[0] != sums[1] || sums[1] != sums[2]) ? 1 : 0;
+
+    const int queries = 300;
+    std::vector<std::pair<std::string, std::string> > pairs = CrossCampusQueries(graph, queries, 11);
+    AStar opaque(new OpaqueEuclidean(), new OpaqueEuclidean());
+    const RoutingStrategy* strategies[] = {
+        &opaque, &AStar::Default(), &StaticAStar<EuclideanPolicy, EuclideanPolicy>::Default()
+    };
+    const char* names[] = {"virtual cost and heuristic", "AStar::Default()", "StaticAStar<Euclidean, Euclidean>"};
+
+    // relaxations are the edges scanned from settled nodes, counted once
+    // outside of the timed runs
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread();
+    double relaxations = 0;
+    for (const auto& query : pairs) {
+        SearchEngine::ShortestPath<EuclideanPolicy, EuclideanPolicy>(
+            compact, compact.IndexOf(query.first), compact.IndexOf(query.second), ws);
+        for (uint32_t node = 0; node < n; node++) {
+            relaxations += ws.Settled(node) ? compact.Degree(node) : 0;
+        }
+    }
+
+    std::cout << pairs.size() << " cross campus queries, " << relaxations / pairs.size()
+              << " relaxations/query" << std::endl;
+    std::vector<float> reference;
+    for (int s = 0; s < 3; s++) {
+        std::vector<float> lengths;
+        Stopwatch watch;
+        for (const auto& query : pairs) {
+            lengths.push_back(PathLength(graph, strategies[s]->GetPath(graph, query.first, query.second)));
+        }
+        const double elapsed = watch.ElapsedMs();
+        std::cout << "  " << names[s] << ": " << 1000 * elapsed / pairs.size() << " us/query, "
+                  << 1e6 * elapsed / relaxations << " ns/relaxation" << std::endl;
+        if (s == 0) {
+            reference = lengths;
+        } else {
+            mismatches += lengths != reference ? 1 : 0;
+        }
+    }
+    std::cout << "  mismatches: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <memory>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/contraction_hierarchy.h"
+
+using namespace routing;
+
+// Ranking drones against waiting robots: every source to every target, by
+// one path search per pair and by the distance matrix.
+int DistanceMatrixBenchmark(IGraph* graph) {
+    const CompactGraph* compact = graph->GetCompactGraph();
+    std::vector<std::vector<float> > sources = RandomPoints(graph, 20, 13);
+    std::vector<std::vector<float> > targets = RandomPoints(graph, 50, 17);
+    std::cout << sources.size() << " x " << targets.size() << " matrix" << std::endl;
+
+    std::vector<std::vector<float> > reference(sources.size());
+    Stopwatch pairs;
+    for (size_t i = 0; i < sources.size(); i++) {
+        const std::string from = graph->NearestNode(sources[i], EuclideanDistance())->GetName();
+        for (size_t j = 0; j < targets.size(); j++) {
+            const std::string to = graph->NearestNode(targets[j], EuclideanDistance())->GetName();
+            std::vector<std::string> path = AStar::Default().GetPath(graph, from, to);
+            reference[i].push_back(path.empty() && from != to ? std::numeric_limits<float>::infinity()
+                                                              : PathLength(graph, path));
+        }
+    }
+    std::cout << "  astar per pair: " << pairs.ElapsedMs() << " ms" << std::endl;
+
+    int mismatches = 0;
+    auto check = [&](const std::vector<std::vector<float> >& matrix) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            for (size_t j = 0; j < targets.size(); j++) {
+                const float expected = reference[i][j];
+                if (!(std::abs(matrix[i][j] - expected) <= 1e-4f * (1 + expected) || matrix[i][j] == expected)) {
+                    mismatches++;
+                }
+            }
+        }
+    };
+
+    Stopwatch oneToMany;
+    std::vector<std::vector<float> > matrix = graph->GetDistanceMatrix(sources, targets);
+    std::cout << "  one to many dijkstra: " << oneToMany.ElapsedMs() << " ms" << std::endl;
+    check(matrix);
+
+    Stopwatch build;
+    compact->SetContractionHierarchy(std::make_shared<const ContractionHierarchy>(*compact));
+    std::cout << "  contraction: " << build.ElapsedMs() << " ms" << std::endl;
+    Stopwatch buckets;
+    matrix = graph->GetDistanceMatrix(sources, targets);
+    std::cout << "  contraction hierarchy buckets: " << buckets.ElapsedMs() << " ms" << std::endl;
+    check(matrix);
+
+    std::cout << "  distance mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+#include <iostream>
+#include <memory>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/landmarks.h"
+#include "routing/search_engine.h"
+
+using namespace routing;
+
+int LandmarkBenchmark(IGraph* graph) {
+    const CompactGraph* compact = graph->GetCompactGraph();
+    std::vector<std::pair<std::string, std::string> > queries = CrossCampusQueries(graph, 200, 7);
+    std::cout << queries.size() << " cross campus queries" << std::endl;
+
+    struct Variant {
+        std::string name;
+        std::unique_ptr<AStar> astar;
+    };
+    std::vector<Variant> variants;
+    variants.push_back({"astar euclidean", std::unique_ptr<AStar>(new AStar())});
+    const LandmarkSelection selections[] = {LandmarkSelection::kFarthest, LandmarkSelection::kAvoid};
+    const char* selectionNames[] = {"farthest", "avoid"};
+    for (int s = 0; s < 2; s++) {
+        for (int count : {4, 8, 16}) {
+            Stopwatch build;
+            std::shared_ptr<const Landmarks> landmarks(new Landmarks(*compact, count, selections[s]));
+            std::string name = "alt " + std::string(selectionNames[s]) + " k=" + std::to_string(count);
+            std::cout << "  " << name << " preprocessing: " << build.ElapsedMs() << " ms" << std::endl;
+            variants.push_back({name, std::unique_ptr<AStar>(
+                new AStar(new EuclideanDistance(), new LandmarkHeuristic(landmarks)))});
+        }
+    }
+
+    std::vector<float> reference;
+    double baseline = 0;
+    int mismatches = 0;
+    for (size_t v = 0; v < variants.size(); v++) {
+        uint64_t settled = 0;
+        std::vector<std::vector<std::string> > paths;
+        Stopwatch time;
+        for (const auto& query : queries) {
+            paths.push_back(variants[v].astar->GetPath(graph, query.first, query.second));
+            settled += SearchWorkspace::ForCurrentThread().SettledCount();
+        }
+        double ms = time.ElapsedMs();
+
+        for (size_t q = 0; q < queries.size(); q++) {
+            float length = PathLength(graph, paths[q]);
+            if (v == 0) {
+                reference.push_back(length);
+            } else if (std::abs(length - reference[q]) > 1e-4f * (1 + reference[q])) {
+                mismatches++;
+            }
+        }
+        double average = settled / double(queries.size());
+        if (v == 0) {
+            baseline = average;
+        }
+        std::cout << "  " << variants[v].name << ": " << average << " settled/query ("
+                  << 100.0 * average / baseline << "%), " << ms * 1000.0 / queries.size()
+                  << " us/query" << std::endl;
+    }
+    std::cout << "  path length mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <map>
+#include <string>
+#include "routing_api.h"
+#include "benchmarks.h"
+
+int main(int argc, char**argv) {
+    using namespace routing;
+
+    std::map<std::string, Benchmark> benchmarks = {
+        {"nearest", NearestNodeBenchmark},
+        {"bidirectional", BidirectionalBenchmark},
+        {"contraction", ContractionBenchmark},
+        {"landmarks", LandmarkBenchmark},
+        {"cache", RouteCacheBenchmark},
+        {"matrix", DistanceMatrixBenchmark},
+        {"tree", ShortestPathTreeBenchmark},
+        {"distance", DistanceBenchmark},
+        {"batch", BatchBenchmark},
+        {"overlay", OverlayBenchmark},
+        {"closures", ClosureBenchmark},
+        {"order", NodeOrderBenchmark},
+        {"budget", BudgetBenchmark},
+    };
+    std::map<std::string, FileBenchmark> fileBenchmarks = {
+        {"osmload", OsmLoadBenchmark},
+        {"objload", ObjLoadBenchmark},
+    };
+    std::map<std::string, ReportBenchmark> reportBenchmarks = {
+        {"suite", SuiteBenchmark},
+    };
+
+    if (argc < 2 || (benchmarks.find(argv[1]) == benchmarks.end() &&
+                     fileBenchmarks.find(argv[1]) == fileBenchmarks.end() &&
+                     reportBenchmarks.find(argv[1]) == reportBenchmarks.end())) {
+        std::cout << "Usage: ./build/bin/routing_benchmark <benchmark> [/path/to/graph] [/path/to/report.json]"
+                  << std::endl;
+        std::cout << "Benchmarks:";
+        for (const auto& kv : benchmarks) {
+            std::cout << " " << kv.first;
+        }
+        for (const auto& kv : fileBenchmarks) {
+            std::cout << " " << kv.first;
+        }
+        for (const auto& kv : reportBenchmarks) {
+            std::cout << " " << kv.first;
+        }
+        std::cout << std::endl;
+        return 0;
+    }
+
+    std::string file = argc > 2 ? argv[2] : "libs/routing/data/umn_st_paul.osm";
+    if (fileBenchmarks.find(argv[1]) != fileBenchmarks.end()) {
+        return fileBenchmarks[argv[1]](file);
+    }
+    RoutingAPI api;
+    Stopwatch load;
+    IGraph* graph = api.LoadFromFile(file);
+    if (!graph) {
+        std::cout << "Unable to parse graph file." << std::endl;
+        return 1;
+    }
+    std::cout << "Loaded " << file << " (" << graph->GetNodes().size() << " nodes) in "
+              << load.ElapsedMs() << " ms" << std::endl;
+
+    int result;
+    if (reportBenchmarks.find(argv[1]) != reportBenchmarks.end()) {
+        result = reportBenchmarks[argv[1]](graph, argc > 3 ? argv[3] : "build/benchmark.json");
+    } else {
+        result = benchmarks[argv[1]](graph);
+    }
+
+    delete graph;
+
+    return result;
+}
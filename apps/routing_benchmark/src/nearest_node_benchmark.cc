@@ -0,0 +1,75 @@
+#include <iostream>
+#include <limits>
+#include "benchmarks.h"
+
+using namespace routing;
+
+// The pre spatial index implementation of GraphBase::NearestNode.
+static const IGraphNode* linearNearestNode(const IGraph* graph, const std::vector<float>& point) {
+    const std::vector<IGraphNode*> nodes = graph->GetNodes();
+    EuclideanDistance distanceFunction;
+    float minDistance = std::numeric_limits<float>::infinity();
+    const IGraphNode* closestNode = nullptr;
+    for (auto* node: nodes) {
+        float distance = distanceFunction.Calculate(node->GetPosition(), point);
+        if (distance < minDistance) {
+            closestNode = node;
+            minDistance = distance;
+        }
+    }
+    return closestNode;
+}
+
+int NearestNodeBenchmark(IGraph* graph) {
+    const int queries = 2000;
+    std::vector<std::vector<float> > points = RandomPoints(graph, queries, 42);
+
+    // build the index outside of the timed region, as graph loading does
+    graph->NearestNode(points[0], EuclideanDistance());
+
+    std::vector<const IGraphNode*> linear, indexed;
+    Stopwatch linearTime;
+    for (const auto& point : points) {
+        linear.push_back(linearNearestNode(graph, point));
+    }
+    double linearMs = linearTime.ElapsedMs();
+
+    Stopwatch indexedTime;
+    for (const auto& point : points) {
+        indexed.push_back(graph->NearestNode(point, EuclideanDistance()));
+    }
+    double indexedMs = indexedTime.ElapsedMs();
+
+    int mismatches = 0;
+    for (int i = 0; i < queries; i++) {
+        if (linear[i] != indexed[i]) {
+            mismatches++;
+        }
+    }
+
+    Stopwatch knnTime;
+    size_t knnResults = 0;
+    for (const auto& point : points) {
+        knnResults += graph->NearestNodes(point, 8).size();
+    }
+    double knnMs = knnTime.ElapsedMs();
+
+    Stopwatch radiusTime;
+    size_t radiusResults = 0;
+    for (const auto& point : points) {
+        radiusResults += graph->NodesWithinRadius(point, 100.0f).size();
+    }
+    double radiusMs = radiusTime.ElapsedMs();
+
+    std::cout << "NearestNode over " << queries << " random points" << std::endl;
+    std::cout << "  linear scan:  " << linearMs * 1000.0 / queries << " us/query" << std::endl;
+    std::cout << "  k-d tree:     " << indexedMs * 1000.0 / queries << " us/query ("
+              << linearMs / indexedMs << "x)" << std::endl;
+    std::cout << "  8-nearest:    " << knnMs * 1000.0 / queries << " us/query, "
+              << knnResults << " results" << std::endl;
+    std::cout << "  radius 100:   " << radiusMs * 1000.0 / queries << " us/query, "
+              << radiusResults << " results" << std::endl;
+    std::cout << "  mismatches:   " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
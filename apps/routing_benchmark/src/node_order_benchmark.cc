@@ -0,0 +1,140 @@
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include "benchmarks.h"
+#include "impl/graph_order.h"
+#include "routing/astar.h"
+
+using namespace routing;
+
+namespace {
+
+// Hardware cache misses of this thread while counting, through
+// perf_event_open. Virtual machines often do not expose the counter.
+class CacheMissCounter {
+public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    bool Available() const { return fd >= 0; }
+    void Start() {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+    uint64_t Stop() {
+        uint64_t count = 0;
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+                count = 0;
+            }
+        }
+        return count;
+    }
+
+private:
+    int fd;
+};
+
+// Share of the edges whose two ends have their positions on the same 4 KiB
+// page.
+double samePageEdges(const CompactGraph& graph) {
+    const uint32_t nodesPerPage = 4096 / (3 * sizeof(float));
+    uint32_t same = 0;
+    for (uint32_t node = 0; node < graph.NumNodes(); node++) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            same += node / nodesPerPage == graph.EdgeTarget(e) / nodesPerPage ? 1 : 0;
+        }
+    }
+    return graph.NumEdges() == 0 ? 0 : double(same) / graph.NumEdges();
+}
+
+}
+
+// A* over the same long trips on the graph as loaded and renumbered along a
+// Hilbert curve and breadth first. Reports the best of a few rounds, the
+// locality of each order and, where the hardware counter is available, the
+// cache misses of the queries. Paths must be as long in every order.
+int NodeOrderBenchmark(IGraph* graph) {
+    const CompactGraph& loaded = *graph->GetCompactGraph();
+    const int rounds = 5;
+    std::vector<std::pair<std::string, std::string> > queries = CrossCampusQueries(graph, 200, 24);
+    const RoutingStrategy& astar = AStar::Default();
+
+    std::vector<float> reference;
+    for (const auto& query : queries) {
+        reference.push_back(PathLength(graph, astar.GetPath(graph, query.first, query.second)));
+    }
+
+    CacheMissCounter misses;
+    std::cout << queries.size() << " cross campus A* queries, best of " << rounds << " rounds" << std::endl;
+    int mismatches = 0;
+    const std::pair<const char*, NodeOrder> orders[] = {
+        {"file", NodeOrder::kFile},
+        {"hilbert", NodeOrder::kHilbert},
+        {"bfs", NodeOrder::kBreadthFirst},
+    };
+    for (const auto& order : orders) {
+        Stopwatch renumberTime;
+        std::unique_ptr<CompactGraph> renumbered(loaded.Renumbered(GraphOrder::Compute(loaded, order.second)));
+        const double renumberMs = renumberTime.ElapsedMs();
+
+        // warms up the workspace
+        astar.GetPath(renumbered.get(), queries[0].first, queries[0].second);
+        double best = 0;
+        uint64_t bestMisses = 0;
+        for (int round = 0; round < rounds; round++) {
+            misses.Start();
+            Stopwatch time;
+            for (const auto& query : queries) {
+                astar.GetPath(renumbered.get(), query.first, query.second);
+            }
+            const double ms = time.ElapsedMs();
+            const uint64_t missed = misses.Stop();
+            if (round == 0 || ms < best) {
+                best = ms;
+                bestMisses = missed;
+            }
+        }
+        for (size_t i = 0; i < queries.size(); i++) {
+            const float length = PathLength(renumbered.get(),
+                                            astar.GetPath(renumbered.get(), queries[i].first, queries[i].second));
+            if (std::fabs(length - reference[i]) > 1e-3f * reference[i]) {
+                mismatches++;
+            }
+        }
+
+        std::cout << "  " << order.first << ": renumbered in " << renumberMs << " ms, mean edge span "
+                  << GraphOrder::MeanEdgeSpan(*renumbered) << ", " << 100 * samePageEdges(*renumbered)
+                  << "% edges within a page, " << 1000 * best / queries.size() << " us per query, ";
+        if (misses.Available()) {
+            std::cout << bestMisses / queries.size() << " cache misses per query" << std::endl;
+        } else {
+            std::cout << "no cache miss counter" << std::endl;
+        }
+    }
+    std::cout << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <memory>
+#include "benchmarks.h"
+#include "parsers/obj/obj_graph.h"
+
+using namespace routing;
+
+// Best of a few loads of an OBJ mesh with the token by token SimpleGraph
+// reader, converted to compact form, and with the mapped file loader. The
+// old reader only knows triangles with plain vertex indices, so the mesh
+// must not use anything else for the graphs to be compared.
+int ObjLoadBenchmark(const std::string& file) {
+    if (file.size() < 4 || file.substr(file.size() - 4) != ".obj") {
+        std::cout << "objload needs an .obj file" << std::endl;
+        return 1;
+    }
+    const int repeats = 5;
+    std::cout << "Loading " << file << " " << repeats << " times each" << std::endl;
+
+    std::unique_ptr<CompactGraph> legacy;
+    double best = 0;
+    uint64_t allocations = 0;
+    for (int i = 0; i < repeats; i++) {
+        const uint64_t allocated = AllocationCount();
+        Stopwatch load;
+        ObjGraph simple(file);
+        legacy.reset(CompactGraph::FromGraph(simple));
+        best = i == 0 ? load.ElapsedMs() : std::min(best, load.ElapsedMs());
+        allocations = AllocationCount() - allocated;
+    }
+    std::cout << "  ObjGraph:     " << best << " ms, " << allocations << " allocations, "
+              << legacy->NumNodes() << " nodes, " << legacy->NumEdges() << " edges" << std::endl;
+
+    std::unique_ptr<CompactGraph> mapped;
+    for (int i = 0; i < repeats; i++) {
+        const uint64_t allocated = AllocationCount();
+        Stopwatch load;
+        mapped.reset(ObjGraph::LoadCompactGraphFromFile(file));
+        best = i == 0 ? load.ElapsedMs() : std::min(best, load.ElapsedMs());
+        allocations = AllocationCount() - allocated;
+    }
+    std::cout << "  mapped file:  " << best << " ms, " << allocations << " allocations, "
+              << mapped->NumNodes() << " nodes, " << mapped->NumEdges() << " edges" << std::endl;
+
+    const bool same = SameGraph(*legacy, *mapped);
+    std::cout << "  graphs " << (same ? "match" : "differ") << std::endl;
+    return same ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#include <iostream>
+#include <memory>
+#include <thread>
+#include "benchmarks.h"
+#include "parsers/osm/osm_stream_parser.h"
+
+using namespace routing;
+
+// Best of a few loads of an OSM file with the serial streaming parser and
+// with the parallel path at 1, 2, 4 and 8 threads.
+int OsmLoadBenchmark(const std::string& file) {
+    const int repeats = 5;
+    std::cout << "Loading " << file << " " << repeats << " times each, "
+              << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    std::unique_ptr<CompactGraph> serial;
+    double best = 0;
+    for (int i = 0; i < repeats; i++) {
+        Stopwatch load;
+        serial.reset(OsmStreamParser::LoadCompactGraphFromFile(file));
+        best = i == 0 ? load.ElapsedMs() : std::min(best, load.ElapsedMs());
+    }
+    std::cout << "  serial: " << best << " ms, " << serial->NumNodes() << " nodes" << std::endl;
+
+    int mismatches = 0;
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        std::unique_ptr<CompactGraph> parallel;
+        for (int i = 0; i < repeats; i++) {
+            Stopwatch load;
+            parallel.reset(OsmStreamParser::ParallelLoadCompactGraphFromFile(file, threads));
+            best = i == 0 ? load.ElapsedMs() : std::min(best, load.ElapsedMs());
+        }
+        std::cout << "  " << threads << " threads: " << best << " ms" << std::endl;
+        mismatches += SameGraph(*serial, *parallel) ? 0 : 1;
+    }
+    std::cout << "  graphs different from serial: " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
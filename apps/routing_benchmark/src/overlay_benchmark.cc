@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include "benchmarks.h"
+#include "routing/customizable_routing.h"
+#include "routing/search_engine.h"
+
+using namespace routing;
+
+// Dijkstra over explicit edge weights, the reference for the overlay.
+static float weightedDistance(const CompactGraph& graph, const std::vector<float>& weights,
+                              uint32_t source, uint32_t target) {
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread();
+    ws.Reset(graph.NumNodes());
+    auto cost = [&weights](uint32_t, uint32_t edge) { return weights[edge]; };
+    auto estimate = [](uint32_t) { return 0.0f; };
+    if (!SearchEngine::AStarSearch(graph, source, target, cost, estimate, ws)) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return ws.Distance(target);
+}
+
+// Partitions the graph, then reweights about 3% of the edges twice: once
+// scattered over the whole map and once around one spot, like a closure or
+// a jam. Reports customization time and query latency against Dijkstra on
+// the same weights.
+int OverlayBenchmark(IGraph* graph) {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    const uint32_t n = compact.NumNodes();
+
+    Stopwatch build;
+    CustomizableRouting routing(compact);
+    const OverlayGraph& overlay = routing.Metric()->Overlay();
+    uint32_t cells = 0;
+    for (int level = 0; level < overlay.NumLevels(); level++) {
+        cells += overlay.NumCells(level);
+    }
+    std::cout << "Partitioned and customized " << n << " nodes in " << build.ElapsedMs() << " ms, "
+              << overlay.NumLevels() << " levels, " << cells << " cells" << std::endl;
+
+    std::mt19937 rng(13);
+    std::vector<std::pair<uint32_t, uint32_t> > queries;
+    for (int i = 0; i < 500; i++) {
+        queries.push_back({uint32_t(rng() % n), uint32_t(rng() % n)});
+    }
+
+    std::vector<uint32_t> edgeSource(compact.NumEdges());
+    for (uint32_t node = 0; node < n; node++) {
+        for (uint32_t e = compact.EdgeBegin(node); e < compact.EdgeEnd(node); e++) {
+            edgeSource[e] = node;
+        }
+    }
+    // the edges closest to a random node, a few percent of the graph
+    const uint32_t changed = compact.NumEdges() * 3 / 100;
+    std::vector<uint32_t> local;
+    std::vector<std::pair<float, uint32_t> > byDistance;
+    const Point3 center = compact.PointAt(rng() % n);
+    for (uint32_t e = 0; e < compact.NumEdges(); e++) {
+        byDistance.push_back({compact.PointAt(edgeSource[e]).distanceBetween(center), e});
+    }
+    std::sort(byDistance.begin(), byDistance.end());
+    for (uint32_t i = 0; i < changed; i++) {
+        local.push_back(byDistance[i].second);
+    }
+    std::vector<uint32_t> scattered;
+    for (uint32_t i = 0; i < changed; i++) {
+        scattered.push_back(rng() % compact.NumEdges());
+    }
+
+    int mismatches = 0;
+    auto measure = [&](const char* name) {
+        std::shared_ptr<const OverlayMetric> metric = routing.Metric();
+        std::vector<uint32_t> path;
+        std::vector<float> distances;
+        Stopwatch time;
+        for (const auto& query : queries) {
+            distances.push_back(metric->ShortestPath(query.first, query.second, path));
+        }
+        const double overlayMs = time.ElapsedMs();
+        Stopwatch dijkstraTime;
+        for (size_t q = 0; q < queries.size(); q++) {
+            const float reference = weightedDistance(compact, metric->Weights(), queries[q].first, queries[q].second);
+            if (std::isinf(reference) != std::isinf(distances[q]) ||
+                (!std::isinf(reference) && std::abs(distances[q] - reference) > 1e-4f * (1 + reference))) {
+                mismatches++;
+            }
+        }
+        const double dijkstraMs = dijkstraTime.ElapsedMs();
+        std::cout << "  " << name << ": overlay " << overlayMs * 1000.0 / queries.size() << " us/query, dijkstra "
+                  << dijkstraMs * 1000.0 / queries.size() << " us/query" << std::endl;
+    };
+    measure("edge lengths");
+
+    const std::vector<uint32_t>* reweightings[] = {&local, &scattered};
+    const char* names[] = {"local", "scattered"};
+    for (int r = 0; r < 2; r++) {
+        std::vector<std::pair<uint32_t, float> > changes;
+        for (uint32_t e : *reweightings[r]) {
+            // one in ten closed, the rest slowed down
+            const float weight = rng() % 10 == 0 ? std::numeric_limits<float>::infinity()
+                                                 : compact.EdgeLength(e) * (2 + rng() % 4);
+            changes.push_back({e, weight});
+        }
+        Stopwatch customize;
+        routing.SetEdgeWeights(changes);
+        std::cout << "Reweighting " << changes.size() << " " << names[r] << " edges"
+                  << " customized " << routing.Metric()->CustomizedCells() << " cells in "
+                  << customize.ElapsedMs() << " ms" << std::endl;
+        measure(names[r]);
+    }
+
+    std::cout << "  mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#include <iostream>
+#include "benchmarks.h"
+#include "routing/astar.h"
+
+using namespace routing;
+
+// Trips between a handful of stations and pickup spots, like the transit
+// simulation produces, with and without the route cache.
+int RouteCacheBenchmark(IGraph* graph) {
+    const int trips = 5000;
+    std::vector<std::vector<float> > spots = RandomPoints(graph, 16, 3);
+    std::mt19937 rng(5);
+    std::vector<std::pair<int, int> > plan;
+    for (int i = 0; i < trips; i++) {
+        plan.push_back({int(rng() % spots.size()), int(rng() % spots.size())});
+    }
+    std::cout << trips << " trips between " << spots.size() << " spots" << std::endl;
+
+    int mismatches = 0;
+    std::vector<SharedPath> reference;
+    for (size_t capacity : {0, 64, 256}) {
+        graph->EnableRouteCache(capacity);
+        std::vector<SharedPath> paths;
+        Stopwatch time;
+        for (const auto& trip : plan) {
+            paths.push_back(graph->GetSharedPath(spots[trip.first], spots[trip.second], AStar::Default()));
+        }
+        double ms = time.ElapsedMs();
+
+        for (int i = 0; i < trips; i++) {
+            if (capacity == 0) {
+                reference.push_back(paths[i]);
+            } else if (*paths[i] != *reference[i]) {
+                mismatches++;
+            }
+        }
+        RouteCacheStats stats = graph->GetRouteCacheStats();
+        std::cout << "  capacity " << capacity << ": " << ms * 1000.0 / trips << " us/trip, "
+                  << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.evictions << " evictions" << std::endl;
+    }
+    graph->EnableRouteCache(0);
+    std::cout << "  path mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include <iostream>
+#include "benchmarks.h"
+#include "routing/astar.h"
+#include "routing/shortest_path_tree.h"
+
+using namespace routing;
+
+// Distances from a few recharge stations to many drones, by one search per
+// pair and by one shortest path tree per station.
+int ShortestPathTreeBenchmark(IGraph* graph) {
+    const CompactGraph* compact = graph->GetCompactGraph();
+    std::vector<std::vector<float> > stations = RandomPoints(graph, 4, 19);
+    std::vector<std::vector<float> > drones = RandomPoints(graph, 250, 23);
+    std::cout << stations.size() << " stations, " << drones.size() << " drones" << std::endl;
+
+    std::vector<std::string> droneNodes;
+    for (const auto& drone : drones) {
+        droneNodes.push_back(graph->NearestNode(drone, EuclideanDistance())->GetName());
+    }
+
+    std::vector<float> reference;
+    Stopwatch pairs;
+    for (const auto& station : stations) {
+        const std::string from = graph->NearestNode(station, EuclideanDistance())->GetName();
+        for (const std::string& to : droneNodes) {
+            reference.push_back(PathLength(graph, AStar::Default().GetPath(graph, from, to)));
+        }
+    }
+    std::cout << "  astar per pair: " << pairs.ElapsedMs() << " ms" << std::endl;
+
+    std::vector<float> distances;
+    Stopwatch trees;
+    for (const auto& station : stations) {
+        std::shared_ptr<const ShortestPathTree> tree = graph->GetShortestPathTree(station);
+        for (const std::string& drone : droneNodes) {
+            distances.push_back(tree->Distance(compact->IndexOf(drone)));
+        }
+    }
+    std::cout << "  one tree per station: " << trees.ElapsedMs() << " ms" << std::endl;
+
+    int mismatches = 0;
+    for (size_t i = 0; i < distances.size(); i++) {
+        if (std::abs(distances[i] - reference[i]) > 1e-4f * (1 + reference[i])) {
+            mismatches++;
+        }
+    }
+
+    BoundingBox bb = graph->GetBoundingBox();
+    const float diagonal = std::sqrt((bb.max[0]-bb.min[0])*(bb.max[0]-bb.min[0]) +
+                                     (bb.max[2]-bb.min[2])*(bb.max[2]-bb.min[2]));
+    for (float fraction : {0.05f, 0.1f, 0.25f}) {
+        Stopwatch time;
+        std::vector<const IGraphNode*> nodes = graph->GetIsochrone(stations[0], fraction * diagonal);
+        std::cout << "  isochrone at " << fraction << " of the diagonal: " << nodes.size()
+                  << " nodes in " << time.ElapsedMs() << " ms" << std::endl;
+    }
+
+    std::cout << "  distance mismatches: " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include "benchmarks.h"
+#include "picojson.h"
+#include "impl/compact_graph.h"
+#include "routing/astar.h"
+#include "routing/bidirectional.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/customizable_routing.h"
+#include "routing/depth_first_search.h"
+#include "routing/dijkstra.h"
+#include "routing/static_astar.h"
+
+using namespace routing;
+
+namespace {
+
+typedef std::vector<std::pair<std::string, std::string> > QuerySet;
+
+// Nearest rank percentile of values, which must be sorted.
+double percentile(const std::vector<double>& values, double p) {
+    if (values.empty()) {
+        return 0;
+    }
+    const size_t rank = static_cast<size_t>(std::ceil(p / 100 * values.size()));
+    return values[std::max<size_t>(rank, 1) - 1];
+}
+
+picojson::value summary(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double value : values) {
+        sum += value;
+    }
+    picojson::object result;
+    result["mean"] = picojson::value(values.empty() ? 0 : sum / values.size());
+    result["p50"] = picojson::value(percentile(values, 50));
+    result["p95"] = picojson::value(percentile(values, 95));
+    result["p99"] = picojson::value(percentile(values, 99));
+    result["max"] = picojson::value(values.empty() ? 0 : values.back());
+    return picojson::value(result);
+}
+
+// The nodes nearest to the four corners of the bounding box in the ground
+// plane, every ordered pair of them: the longest trips the graph has.
+QuerySet cornerQueries(const IGraph* graph) {
+    BoundingBox bb = graph->GetBoundingBox();
+    const float height = (bb.min[1] + bb.max[1]) / 2;
+    std::vector<std::string> corners;
+    for (float x : {bb.min[0], bb.max[0]}) {
+        for (float z : {bb.min[2], bb.max[2]}) {
+            const std::string corner = graph->NearestNode({x, height, z}, EuclideanDistance())->GetName();
+            // small maps can share a corner node
+            if (std::find(corners.begin(), corners.end(), corner) == corners.end()) {
+                corners.push_back(corner);
+            }
+        }
+    }
+    QuerySet queries;
+    for (const std::string& from : corners) {
+        for (const std::string& to : corners) {
+            if (from != to) {
+                queries.push_back({from, to});
+            }
+        }
+    }
+    return queries;
+}
+
+QuerySet randomQueries(const IGraph* graph, int count, unsigned seed) {
+    std::vector<std::vector<float> > points = RandomPoints(graph, 2 * count, seed);
+    QuerySet queries;
+    for (int i = 0; i < count; i++) {
+        queries.push_back({graph->NearestNode(points[2*i], EuclideanDistance())->GetName(),
+                           graph->NearestNode(points[2*i+1], EuclideanDistance())->GetName()});
+    }
+    return queries;
+}
+
+}
+
+// Latency, settled nodes and allocations of every routing strategy over
+// reproducible query sets: random trips and the bounding box corner to
+// corner trips, the worst case for searches that grow from the source.
+// Prints a table and writes the same numbers as JSON to report, so runs on
+// different commits can be compared. Every path must follow the edges of
+// the graph, and those of exact strategies must be as short as Dijkstra's.
+int SuiteBenchmark(IGraph* graph, const std::string& report) {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    const int rounds = 10;
+
+    CustomizableRouting customizable(compact);
+    struct Strategy {
+        std::string name;
+        const RoutingStrategy* strategy;
+        // finds shortest paths, as opposed to fewest edges
+        bool exact;
+    };
+    // add new strategies here
+    const std::vector<Strategy> strategies = {
+        {"astar", &AStar::Default(), true},
+        {"static_astar", &StaticAStar<EuclideanPolicy, EuclideanPolicy>::Default(), true},
+        {"dijkstra", &Dijkstra::Instance(), true},
+        {"breadth_first", &DepthFirstSearch::Default(), false},
+        {"depth_first", &DepthFirstSearch::DepthFirst(), false},
+        {"bidirectional", &BidirectionalSearch::Default(), true},
+        {"contraction", &ContractionHierarchies::Default(), true},
+        {"customizable", &customizable, true},
+    };
+    const std::vector<std::pair<std::string, QuerySet> > sets = {
+        {"random", randomQueries(graph, 500, 1)},
+        {"corners", cornerQueries(graph)},
+    };
+
+    // builds the hierarchy and sizes the search workspaces
+    for (const Strategy& strategy : strategies) {
+        strategy.strategy->GetPath(graph, sets[0].second[0].first, sets[0].second[0].second);
+    }
+
+    picojson::array results;
+    int mismatches = 0;
+    std::cout << std::left << std::setw(14) << "strategy" << std::setw(9) << "queries" << std::right
+              << std::setw(10) << "p50 us" << std::setw(10) << "p95 us" << std::setw(10) << "p99 us"
+              << std::setw(10) << "settled" << std::setw(8) << "allocs" << std::endl;
+    for (const auto& set : sets) {
+        std::vector<float> reference;
+        for (const auto& query : set.second) {
+            reference.push_back(PathLength(graph, Dijkstra::Instance().GetPath(graph, query.first, query.second)));
+        }
+
+        for (const Strategy& strategy : strategies) {
+            std::vector<double> us, settled, allocations;
+            int wrong = 0;
+            // corner trips are few, so they run several rounds
+            const int repeat = set.second.size() < 100 ? rounds : 1;
+            for (int round = 0; round < repeat; round++) {
+                for (size_t i = 0; i < set.second.size(); i++) {
+                    SearchWorkspace::ForCurrentThread(0).Reset(compact.NumNodes());
+                    SearchWorkspace::ForCurrentThread(1).Reset(compact.NumNodes());
+                    const uint64_t allocated = AllocationCount();
+                    Stopwatch time;
+                    std::vector<std::string> path = strategy.strategy->GetPath(graph, set.second[i].first,
+                                                                              set.second[i].second);
+                    us.push_back(time.ElapsedMs() * 1000);
+                    allocations.push_back(static_cast<double>(AllocationCount() - allocated));
+                    settled.push_back(SearchWorkspace::ForCurrentThread(0).SettledCount() +
+                                      SearchWorkspace::ForCurrentThread(1).SettledCount());
+                    if (round > 0) {
+                        continue;
+                    }
+                    bool valid = !path.empty() && path.front() == set.second[i].first &&
+                                 path.back() == set.second[i].second;
+                    for (size_t j = 1; valid && j < path.size(); j++) {
+                        valid = compact.FindEdge(path[j-1], path[j]) != CompactGraph::kInvalidEdge;
+                    }
+                    const float length = PathLength(graph, path);
+                    if (!valid || (strategy.exact && std::fabs(length - reference[i]) > 1e-3f * reference[i])) {
+                        wrong++;
+                    }
+                }
+            }
+            mismatches += wrong;
+
+            picojson::object result;
+            result["strategy"] = picojson::value(strategy.name);
+            result["queries"] = picojson::value(set.first);
+            result["samples"] = picojson::value(static_cast<double>(us.size()));
+            result["latency_us"] = summary(us);
+            result["settled"] = summary(settled);
+            result["allocations"] = summary(allocations);
+            result["mismatches"] = picojson::value(static_cast<double>(wrong));
+            results.push_back(picojson::value(result));
+
+            const picojson::object& latency = result["latency_us"].get<picojson::object>();
+            std::cout << std::left << std::setw(14) << strategy.name << std::setw(9) << set.first << std::right
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(10) << latency.at("p50").get<double>()
+                      << std::setw(10) << latency.at("p95").get<double>()
+                      << std::setw(10) << latency.at("p99").get<double>()
+                      << std::setw(10) << result["settled"].get<picojson::object>().at("mean").get<double>()
+                      << std::setw(8) << result["allocations"].get<picojson::object>().at("mean").get<double>()
+                      << std::defaultfloat << (wrong > 0 ? "  MISMATCH" : "") << std::endl;
+        }
+    }
+
+    picojson::object document;
+    document["nodes"] = picojson::value(static_cast<double>(compact.NumNodes()));
+    document["edges"] = picojson::value(static_cast<double>(compact.NumEdges()));
+    document["time"] = picojson::value(static_cast<double>(std::time(nullptr)));
+    picojson::object counts;
+    for (const auto& set : sets) {
+        counts[set.first] = picojson::value(static_cast<double>(set.second.size()));
+    }
+    document["query_sets"] = picojson::value(counts);
+    document["results"] = picojson::value(results);
+
+    std::ofstream out(report);
+    if (!out) {
+        std::cout << "Unable to write " << report << std::endl;
+        return 1;
+    }
+    out << picojson::value(document).serialize(true);
+    std::cout << "Report written to " << report << std::endl;
+    std::cout << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
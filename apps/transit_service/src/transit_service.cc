@@ -1,8 +1,11 @@
 #include <map>
 #include <chrono>
+#include <fstream>
 #include "WebServer.h"
 #include "SimulationModel.h"
 #include "routing_api.h"
+#include "util/polyline.h"
+#include "PathStrategy.h"
 #include "../libs/transit/include/DataCollection.h"
 
 //--------------------  Controller ----------------------------
@@ -16,7 +19,16 @@ class TransitService : public JsonSession, public IController {
   explicit TransitService(SimulationModel &model)
       : model(model), start(std::chrono::system_clock::now()), time(0.0) {
     routing::RoutingAPI api;
-    routing::IGraph *graph = api.LoadFromFile("libs/routing/data/umn.osm");
+    // a graph exported with graph_export maps in milliseconds instead of
+    // being parsed from the osm file on every start
+    routing::IGraph *graph = NULL;
+    if (std::ifstream("libs/routing/data/umn.rgraph")) {
+      graph = api.LoadFromFile("libs/routing/data/umn.rgraph");
+    } else {
+      graph = api.LoadFromFile("libs/routing/data/umn.osm");
+    }
+    // drones keep flying between the same stations and pickup spots
+    graph->EnableRouteCache(1024);
     model.SetGraph(graph);
   }
 
@@ -99,16 +111,12 @@ class TransitService : public JsonSession, public IController {
   }
 
   void AddPath(int id, const std::vector<std::vector<float> > &path) override {
+    // simplified to the same waypoints PathStrategy follows and sent as
+    // one encoded polyline string instead of an array per vertex
     JsonObject details;
-    JsonArray array = (JsonArray) details["path"];
-    array.Resize((int) path.size());
-    for (int i = 0; i < path.size(); i++) {
-      JsonArray point = (JsonArray) array[i];
-      point.Resize(3);
-      point[0] = path[i][0];
-      point[1] = path[i][1];
-      point[2] = path[i][2];
-    }
+    details["id"] = id;
+    details["path"] = routing::Polyline::Encode(
+        routing::Polyline::Simplify(path, PathStrategy::kSimplifyTolerance));
     SendEventToView("AddPath", details);
   }
 
@@ -27,6 +27,31 @@ const objloader = new THREE.OBJLoader();
 var simSpeed = 1.0;
 // Function definitions start here...
 
+// Decodes a path sent as an encoded polyline (see routing::Polyline) into
+// [x, y, z] points. Every component is a zigzag varint delta against the
+// previous point, 5 bits per character, scaled by 10^precision.
+function decodePath(encoded, precision = 1) {
+  const scale = Math.pow(10, precision);
+  const points = [];
+  const value = [0, 0, 0];
+  let at = 0;
+  while (at < encoded.length) {
+    const point = [];
+    for (let j = 0; j < 3; j++) {
+      let result = 0, factor = 1, chunk;
+      do {
+        chunk = encoded.charCodeAt(at++) - 63;
+        result += (chunk & 0x1f) * factor;
+        factor *= 32;
+      } while (chunk >= 0x20);
+      value[j] += result % 2 ? -(result + 1) / 2 : result / 2;
+      point.push(value[j] / scale);
+    }
+    points.push(point);
+  }
+  return points;
+}
+
 // This is the function that is called once the document is started.
 $( document ).ready(function() {
   var simSpeedSlider = document.getElementById("simSpeed");
@@ -269,7 +294,8 @@ function displayJSON(data) {
         //create a blue LineBasicMaterial
         var material = new THREE.LineBasicMaterial( { color: 0xf0fc03 } );
         const points = [];
-        for (var point of  data["path"]) {
+        const path = typeof data["path"] === "string" ? decodePath(data["path"]) : data["path"];
+        for (var point of path) {
           points.push( new THREE.Vector3( point[0], point[1], point[2] ) );
         }
         /*points.push( new THREE.Vector3( - 10, 0, 0 ) );
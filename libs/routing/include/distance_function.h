@@ -1,12 +1,21 @@
 #ifndef DISTANCE_FUNCTION_H_
 #define DISTANCE_FUNCTION_H_
 
+#include <cmath>
+#include <vector>
+#include "distance_policy.h"
+
 namespace routing {
 
 class DistanceFunction {
 public:
 	virtual ~DistanceFunction() {}
 	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const = 0;
+	// Distance between two packed x, y, z positions. Used by the search
+	// engine; the default copies into vectors so subclasses should override.
+	virtual float Calculate(const float* a, const float* b) const {
+		return Calculate(std::vector<float>(a, a+3), std::vector<float>(b, b+3));
+	}
 };
 
 class EuclideanDistance : public DistanceFunction {
@@ -20,6 +29,9 @@ public:
 		}
 		return std::sqrt(sum);
 	}
+	virtual float Calculate(const float* a, const float* b) const {
+		return EuclideanPolicy::Between(a, b);
+	}
 };
 
 class ZeroDistance : public DistanceFunction {
@@ -28,6 +40,33 @@ public:
 	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const {
 		return 0;
 	}
+	virtual float Calculate(const float*, const float*) const {
+		return 0;
+	}
+};
+
+// Virtual adapter for a distance policy, for APIs that take a
+// DistanceFunction. The search engine recognizes the policy and runs the
+// inlined kernel instead of calling through this class.
+template <class Policy>
+class PolicyDistance : public DistanceFunction {
+public:
+	virtual ~PolicyDistance() {}
+	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const {
+		if (a.size() < 3 || b.size() < 3) {
+			return Policy::Between(padded(a).data(), padded(b).data());
+		}
+		return Policy::Between(a.data(), b.data());
+	}
+	virtual float Calculate(const float* a, const float* b) const {
+		return Policy::Between(a, b);
+	}
+
+private:
+	static std::vector<float> padded(std::vector<float> v) {
+		v.resize(3, 0.0f);
+		return v;
+	}
 };
 
 }
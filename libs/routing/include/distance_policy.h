@@ -0,0 +1,64 @@
+#ifndef DISTANCE_POLICY_H_
+#define DISTANCE_POLICY_H_
+
+#include <cmath>
+#include "parsers/osm/point3.h"
+
+namespace routing {
+
+// Distance policies are stateless distance kernels on packed x, y, z
+// positions, for code that picks its metric at compile time. Between() is
+// static and inlinable, and every policy can also be called on Point3s.
+// PolicyDistance in distance_function.h wraps one as a DistanceFunction.
+
+struct EuclideanPolicy {
+	static float Between(const float* a, const float* b) {
+		float dx = b[0]-a[0], dy = b[1]-a[1], dz = b[2]-a[2];
+		return std::sqrt(dx*dx + dy*dy + dz*dz);
+	}
+	float operator()(const Point3& a, const Point3& b) const { return Between(a.p, b.p); }
+};
+
+// Same order as EuclideanPolicy without the square root, for nearest
+// neighbour comparisons. Not a valid search cost or heuristic.
+struct SquaredEuclideanPolicy {
+	static float Between(const float* a, const float* b) {
+		float dx = b[0]-a[0], dy = b[1]-a[1], dz = b[2]-a[2];
+		return dx*dx + dy*dy + dz*dz;
+	}
+	float operator()(const Point3& a, const Point3& b) const { return Between(a.p, b.p); }
+};
+
+// Overestimates euclidean distances, so it is only an admissible heuristic
+// together with a Manhattan cost.
+struct ManhattanPolicy {
+	static float Between(const float* a, const float* b) {
+		return std::fabs(b[0]-a[0]) + std::fabs(b[1]-a[1]) + std::fabs(b[2]-a[2]);
+	}
+	float operator()(const Point3& a, const Point3& b) const { return Between(a.p, b.p); }
+};
+
+// Turns A* into Dijkstra when used as the heuristic.
+struct ZeroPolicy {
+	static float Between(const float*, const float*) { return 0; }
+	float operator()(const Point3&, const Point3&) const { return 0; }
+};
+
+// Great circle distance in meters between latitude, longitude pairs in
+// degrees, stored in the first two components. For raw OSM coordinates,
+// not for the projected positions of a loaded graph.
+struct HaversinePolicy {
+	static constexpr float kEarthRadius = 6371008.8f;
+	static float Between(const float* a, const float* b) {
+		const float toRadians = 3.14159265f / 180.0f;
+		float dLat = (b[0]-a[0]) * toRadians, dLon = (b[1]-a[1]) * toRadians;
+		float sinLat = std::sin(dLat / 2), sinLon = std::sin(dLon / 2);
+		float h = sinLat*sinLat + std::cos(a[0]*toRadians) * std::cos(b[0]*toRadians) * sinLon*sinLon;
+		return 2 * kEarthRadius * std::asin(std::sqrt(std::fmin(h, 1.0f)));
+	}
+	float operator()(const Point3& a, const Point3& b) const { return Between(a.p, b.p); }
+};
+
+}
+
+#endif
@@ -1,18 +1,26 @@
 #ifndef GRAPH_H_
 #define GRAPH_H_
 
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
 #include <cmath>
+#include <memory>
+#include <mutex>
 #include "routing_strategy.h"
+#include "search_budget.h"
 #include "distance_function.h"
 #include "bounding_box.h"
+#include "route_cache.h"
+#include "parsers/osm/point3.h"
 
 namespace routing {
 
 class IGraphNode;
 class RoutingStrategy;
+class CompactGraph;
+class ShortestPathTree;
 
 class IGraph {
  public:
@@ -22,9 +30,63 @@ class IGraph {
   [[nodiscard]] virtual BoundingBox GetBoundingBox() const = 0;
   [[nodiscard]] virtual const IGraphNode *NearestNode(std::vector<float> point,
                                                       const DistanceFunction &distance) const = 0;
+  // Euclidean k-nearest and radius queries, closest first.
+  [[nodiscard]] virtual std::vector<const IGraphNode *> NearestNodes(std::vector<float> point,
+                                                                     int k) const = 0;
+  [[nodiscard]] virtual std::vector<const IGraphNode *> NodesWithinRadius(std::vector<float> point,
+                                                                          float radius) const = 0;
   [[nodiscard]] virtual const std::vector<std::vector<float> > GetPath(std::vector<float> src,
                                                                        std::vector<float> dest,
                                                                        const RoutingStrategy &strategy) const = 0;
+  // Same path as GetPath(), shared with the route cache when it is enabled.
+  [[nodiscard]] virtual SharedPath GetSharedPath(std::vector<float> src,
+                                                 std::vector<float> dest,
+                                                 const RoutingStrategy &strategy) const = 0;
+  // GetSharedPath() within budget, see RoutingStrategy::GetRoute(). When
+  // the budget runs out the path follows the partial route and then goes
+  // straight to dest; such paths are not cached. status may be null.
+  [[nodiscard]] virtual SharedPath GetSharedPath(std::vector<float> src,
+                                                 std::vector<float> dest,
+                                                 const RoutingStrategy &strategy,
+                                                 const SearchBudget &budget,
+                                                 RouteStatus *status) const = 0;
+  // Network distances from the node nearest to each source to the node
+  // nearest to each target, one row per source and infinite where
+  // unreachable. No paths are built.
+  [[nodiscard]] virtual std::vector<std::vector<float> > GetDistanceMatrix(
+      const std::vector<std::vector<float> > &sources,
+      const std::vector<std::vector<float> > &targets) const = 0;
+  // One-to-all distances and parents from the node nearest to source.
+  // Node indices are positions in GetNodes().
+  [[nodiscard]] virtual std::shared_ptr<const ShortestPathTree> GetShortestPathTree(
+      std::vector<float> source) const = 0;
+  // Nodes at most distance along the network from the node nearest to
+  // source, closest first. For a time budget pass seconds * speed.
+  [[nodiscard]] virtual std::vector<const IGraphNode *> GetIsochrone(std::vector<float> source,
+                                                                     float distance) const = 0;
+  // Caches up to capacity paths by snapped start and end node and
+  // strategy. A capacity of 0 disables the cache.
+  virtual void EnableRouteCache(size_t capacity) = 0;
+  [[nodiscard]] virtual RouteCacheStats GetRouteCacheStats() const = 0;
+  // Index based view of this graph used by the search engines.
+  [[nodiscard]] virtual const CompactGraph *GetCompactGraph() const = 0;
+  // Runtime cost of the edge from -> to, see CompactGraph::SetEdgeWeight().
+  // Return false if there is no such edge; a two way street has one edge
+  // each way. Cached routes that may have changed are dropped on the next
+  // query.
+  virtual bool SetEdgeWeight(const std::string &from, const std::string &to, float weight) = 0;
+  virtual bool SetEdgeEnabled(const std::string &from, const std::string &to, bool enabled) = 0;
+  // Number of edge cost changes so far; calls that leave every cost as it
+  // was do not count. A path is only known to be current at
+  // the version it was computed at.
+  [[nodiscard]] virtual uint64_t GetVersion() const = 0;
+  // path, computed at version, with the part after vertex from routed
+  // again around the edges changed since: strategy only searches between
+  // the vertices just before the first and just after the last changed
+  // edge on it. Returns path itself if that part crosses no changed edge
+  // and nullptr if the rest of the route became unreachable.
+  [[nodiscard]] virtual SharedPath RepairPath(const SharedPath &path, size_t from, uint64_t version,
+                                              const RoutingStrategy &strategy) const = 0;
 };
 
 class IGraphNode {
@@ -33,17 +95,63 @@ class IGraphNode {
   [[nodiscard]] virtual const std::string &GetName() const = 0;
   [[nodiscard]] virtual const std::vector<IGraphNode *> &GetNeighbors() const = 0;
   [[nodiscard]] virtual const std::vector<float> GetPosition() const = 0;
+  // Same position without allocating, padded with 0 to three components.
+  // Use this in loops over nodes; the default goes through GetPosition().
+  [[nodiscard]] virtual Point3 GetPoint() const { return Point3::FromVec(GetPosition()); }
 };
 
 class GraphBase : public IGraph {
  public:
-  ~GraphBase() override = default;
+  GraphBase();
+  ~GraphBase() override;
   [[nodiscard]] BoundingBox GetBoundingBox() const override;
+  // Uses the spatial index of GetCompactGraph() for euclidean distances
+  // and falls back to a linear scan for any other distance function.
   [[nodiscard]] const IGraphNode *NearestNode(std::vector<float> point,
                                               const DistanceFunction &distance) const override;
+  [[nodiscard]] std::vector<const IGraphNode *> NearestNodes(std::vector<float> point,
+                                                             int k) const override;
+  [[nodiscard]] std::vector<const IGraphNode *> NodesWithinRadius(std::vector<float> point,
+                                                                  float radius) const override;
   [[nodiscard]] const std::vector<std::vector<float> > GetPath(std::vector<float> src,
                                                                std::vector<float> dest,
                                                                const RoutingStrategy &strategy) const override;
+  [[nodiscard]] SharedPath GetSharedPath(std::vector<float> src,
+                                         std::vector<float> dest,
+                                         const RoutingStrategy &strategy) const override;
+  [[nodiscard]] SharedPath GetSharedPath(std::vector<float> src,
+                                         std::vector<float> dest,
+                                         const RoutingStrategy &strategy,
+                                         const SearchBudget &budget,
+                                         RouteStatus *status) const override;
+  // Reuses the contraction hierarchy of GetCompactGraph() if it is built.
+  [[nodiscard]] std::vector<std::vector<float> > GetDistanceMatrix(
+      const std::vector<std::vector<float> > &sources,
+      const std::vector<std::vector<float> > &targets) const override;
+  [[nodiscard]] std::shared_ptr<const ShortestPathTree> GetShortestPathTree(
+      std::vector<float> source) const override;
+  [[nodiscard]] std::vector<const IGraphNode *> GetIsochrone(std::vector<float> source,
+                                                             float distance) const override;
+  void EnableRouteCache(size_t capacity) override;
+  [[nodiscard]] RouteCacheStats GetRouteCacheStats() const override;
+  // Built on first use. Graphs that are modified afterwards must call
+  // InvalidateCompactGraph(), which also empties the route cache and
+  // discards the edge changes.
+  [[nodiscard]] const CompactGraph *GetCompactGraph() const override;
+  bool SetEdgeWeight(const std::string &from, const std::string &to, float weight) override;
+  bool SetEdgeEnabled(const std::string &from, const std::string &to, bool enabled) override;
+  [[nodiscard]] uint64_t GetVersion() const override;
+  [[nodiscard]] SharedPath RepairPath(const SharedPath &path, size_t from, uint64_t version,
+                                      const RoutingStrategy &strategy) const override;
+
+ protected:
+  void InvalidateCompactGraph();
+
+ private:
+  mutable std::mutex compactMutex;
+  mutable std::unique_ptr<CompactGraph> compact;
+  mutable std::mutex routeCacheMutex;
+  std::shared_ptr<RouteCache> routeCache;
 };
 
 }
@@ -0,0 +1,244 @@
+#ifndef COMPACT_GRAPH_H_
+#define COMPACT_GRAPH_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "parsers/osm/point3.h"
+#include "spatial_index.h"
+
+namespace routing {
+
+class CompactGraph;
+class ContractionHierarchy;
+
+// IGraphNode view over one row of a CompactGraph. Only exists so that the
+// string based IGraph API keeps working; searches should use the indices.
+class CompactGraphNode : public IGraphNode {
+    public:
+        CompactGraphNode(const CompactGraph* graph, uint32_t index)
+            : graph_(graph), index_(index) {}
+        const std::string& GetName() const override;
+        // The neighbor lists of all views are built on the first call.
+        const std::vector<IGraphNode*>& GetNeighbors() const override;
+        const std::vector<float> GetPosition() const override;
+        Point3 GetPoint() const override;
+        uint32_t GetIndex() const { return index_; }
+
+    private:
+        const CompactGraph* graph_;
+        uint32_t index_;
+};
+
+// Node and edge arrays of a CompactGraph that live outside of it, e.g. in a
+// memory mapped file. See the CompactGraph members for their layout.
+struct CompactGraphArrays {
+    uint32_t numNodes = 0;
+    uint32_t numEdges = 0;
+    const float* positions = nullptr;
+    const uint32_t* offsets = nullptr;
+    const uint32_t* targets = nullptr;
+    const float* lengths = nullptr;
+};
+
+// One runtime edge change, see CompactGraph::ChangesSince().
+struct EdgeChange {
+    uint32_t edge;
+    // The edge got cheaper or was opened again, so routes that avoid it
+    // may no longer be the shortest.
+    bool decreased;
+};
+
+// Graph with dense uint32_t node ids. Adjacency is stored in compressed
+// sparse row form: the out edges of node n are the edge ids in
+// [EdgeBegin(n), EdgeEnd(n)), and every edge stores its target and its
+// precomputed euclidean length. Positions are packed as x, y, z triples.
+// The topology never changes; edge costs can, see SetEdgeWeight().
+class CompactGraph : public GraphBase {
+    public:
+        static constexpr uint32_t kInvalidNode = UINT32_MAX;
+        static constexpr uint32_t kInvalidEdge = UINT32_MAX;
+
+        // offsets must have names.size() + 1 entries and positions must
+        // have 3 * names.size() entries.
+        CompactGraph(std::vector<std::string> names,
+                     std::vector<float> positions,
+                     std::vector<uint32_t> offsets,
+                     std::vector<uint32_t> targets);
+        // Uses the arrays in place instead of copying them; storage must
+        // keep them alive. Throws invalid_argument if they are inconsistent.
+        CompactGraph(std::vector<std::string> names, const CompactGraphArrays& arrays,
+                     std::shared_ptr<const void> storage);
+        ~CompactGraph() override = default;
+
+        // Copies any graph into compact form, keeping the node order of
+        // graph.GetNodes() and dropping duplicate edges.
+        static CompactGraph* FromGraph(const IGraph& graph);
+
+        // The nodes with keep[node] set and the edges between them, in the
+        // same order. Works on the arrays without any name lookups.
+        CompactGraph* Subgraph(const std::vector<char>& keep) const;
+        // The same graph with node i of the result being node order[i] of
+        // this one, see GraphOrder. Names and positions move with their
+        // nodes; edge costs start out as the euclidean lengths again.
+        // Throws invalid_argument if order is not a permutation.
+        CompactGraph* Renumbered(const std::vector<uint32_t>& order) const;
+
+        const IGraphNode* GetNode(const std::string& name) const override;
+        const std::vector<IGraphNode*>& GetNodes() const override
+            { return nodes_; }
+        const CompactGraph* GetCompactGraph() const override { return this; }
+        BoundingBox GetBoundingBox() const override { return bounds_; }
+
+        uint32_t NumNodes() const { return static_cast<uint32_t>(names_.size()); }
+        uint32_t NumEdges() const { return numEdges_; }
+
+        // Returns kInvalidNode if there is no node with the given name.
+        uint32_t IndexOf(const std::string& name) const;
+        const std::string& NameOf(uint32_t node) const { return names_[node]; }
+        const CompactGraphNode* NodeAt(uint32_t node) const { return &views_[node]; }
+
+        const float* Position(uint32_t node) const { return &positions_[3*node]; }
+        Point3 PointAt(uint32_t node) const {
+            const float* p = Position(node);
+            return Point3(p[0], p[1], p[2]);
+        }
+
+        uint32_t EdgeBegin(uint32_t node) const { return offsets_[node]; }
+        uint32_t EdgeEnd(uint32_t node) const { return offsets_[node+1]; }
+        uint32_t Degree(uint32_t node) const { return offsets_[node+1] - offsets_[node]; }
+        uint32_t EdgeTarget(uint32_t edge) const { return targets_[edge]; }
+        // The cost of the edge: its euclidean length, the weight it was
+        // given, or infinity while it is closed.
+        float EdgeLength(uint32_t edge) const { return lengths_[edge]; }
+        bool EdgeOpen(uint32_t edge) const { return lengths_[edge] < kClosed; }
+        // kInvalidEdge if there is no edge from -> to.
+        uint32_t FindEdge(uint32_t from, uint32_t to) const;
+        uint32_t FindEdge(const std::string& from, const std::string& to) const;
+
+        // Reverse adjacency: the in edges of node n are the reverse edge ids
+        // in [ReverseEdgeBegin(n), ReverseEdgeEnd(n)). Each maps back to the
+        // forward edge it mirrors.
+        uint32_t ReverseEdgeBegin(uint32_t node) const { return reverseOffsets_[node]; }
+        uint32_t ReverseEdgeEnd(uint32_t node) const { return reverseOffsets_[node+1]; }
+        uint32_t ReverseEdgeSource(uint32_t reverseEdge) const { return reverseSources_[reverseEdge]; }
+        uint32_t ReverseEdgeForward(uint32_t reverseEdge) const { return reverseEdges_[reverseEdge]; }
+
+        // k-d tree over the node positions, ids are node indices
+        const SpatialIndex& GetSpatialIndex() const { return spatialIndex_; }
+
+        // Built on first use, which takes a while on large graphs. A
+        // hierarchy loaded from disk can be installed up front instead.
+        std::shared_ptr<const ContractionHierarchy> GetContractionHierarchy() const;
+        // nullptr unless the hierarchy was already built or installed
+        std::shared_ptr<const ContractionHierarchy> FindContractionHierarchy() const;
+        void SetContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy) const;
+
+        // The raw node and edge arrays, e.g. for writing them to a file.
+        // lengths holds the current edge costs, see EdgeLength().
+        CompactGraphArrays Arrays() const;
+
+        // Runtime edge changes. A weight replaces the cost of an edge; a
+        // closed edge keeps its weight and is skipped by every search until
+        // it is opened again. A call that changes the cost an edge has
+        // right now bumps Version() and drops the contraction hierarchy;
+        // setting the same cost again, or the weight of a closed edge,
+        // does neither. Searches read the costs without locking,
+        // so change edges between queries. Weights below the euclidean
+        // length make the A* heuristics overestimate.
+        void SetEdgeWeight(uint32_t edge, float weight);
+        void SetEdgeEnabled(uint32_t edge, bool enabled);
+        bool SetEdgeWeight(const std::string& from, const std::string& to, float weight) override;
+        bool SetEdgeEnabled(const std::string& from, const std::string& to, bool enabled) override;
+
+        // Number of effective edge cost changes so far.
+        uint64_t Version() const { return version_.load(); }
+        uint64_t GetVersion() const override { return Version(); }
+        // Version right after the last change that made an edge cheaper.
+        uint64_t LastDecrease() const { return lastDecrease_.load(); }
+        // The changes after version, oldest first; an edge changed twice
+        // shows up twice.
+        std::vector<EdgeChange> ChangesSince(uint64_t version) const;
+
+    private:
+        static constexpr float kClosed = 3.0e38f;
+
+        void init();
+        // Fills weights_ and closed_ and takes ownership of the lengths.
+        // Called with edgeMutex_ held.
+        void editable();
+        // Records that edge now costs cost instead of previous.
+        void changed(uint32_t edge, float previous, float cost);
+
+        std::vector<std::string> names_;
+        // Point into the owned vectors below or into storage_.
+        const float* positions_ = nullptr;
+        const uint32_t* offsets_ = nullptr;
+        const uint32_t* targets_ = nullptr;
+        const float* lengths_ = nullptr;
+        uint32_t numEdges_ = 0;
+        std::vector<float> ownedPositions_;
+        std::vector<uint32_t> ownedOffsets_;
+        std::vector<uint32_t> ownedTargets_;
+        std::vector<float> ownedLengths_;
+        std::shared_ptr<const void> storage_;
+        // Edge changes. lengths_ is moved into ownedLengths_ on the first
+        // one; weights_ and closed_ are filled on first use as well.
+        mutable std::mutex edgeMutex_;
+        std::vector<float> weights_;
+        std::vector<char> closed_;
+        std::vector<EdgeChange> changes_;
+        std::atomic<uint64_t> version_{0};
+        std::atomic<uint64_t> lastDecrease_{0};
+        BoundingBox bounds_;
+        std::vector<uint32_t> reverseOffsets_;
+        std::vector<uint32_t> reverseSources_;
+        std::vector<uint32_t> reverseEdges_;
+        // Open addressing table from name hash to node, kInvalidNode where
+        // empty, with at least twice as many slots as nodes. One array
+        // instead of a map entry per node.
+        std::vector<uint32_t> nameTable_;
+        SpatialIndex spatialIndex_;
+        mutable std::mutex hierarchyMutex_;
+        mutable std::shared_ptr<const ContractionHierarchy> hierarchy_;
+
+        // string API compatibility layer
+        friend class CompactGraphNode;
+        const std::vector<IGraphNode*>& neighborsOf(uint32_t node) const;
+        std::vector<CompactGraphNode> views_;
+        std::vector<IGraphNode*> nodes_;
+        mutable std::once_flag neighborsOnce_;
+        mutable std::vector<std::vector<IGraphNode*> > neighbors_;
+};
+
+// Collects nodes and edges in any order and produces a CompactGraph.
+class CompactGraphBuilder {
+    public:
+        // Throws invalid_argument if a node with the same name was added.
+        uint32_t AddNode(const std::string& name, const Point3& position);
+        void AddEdge(uint32_t from, uint32_t to);
+        // Returns false if either node is unknown.
+        bool AddEdge(const std::string& from, const std::string& to);
+
+        uint32_t IndexOf(const std::string& name) const;
+        uint32_t NumNodes() const { return static_cast<uint32_t>(names_.size()); }
+
+        // Sorts and deduplicates the edges. The builder is empty afterwards.
+        CompactGraph* Build();
+
+    private:
+        std::vector<std::string> names_;
+        std::vector<float> positions_;
+        std::vector<std::pair<uint32_t, uint32_t> > edges_;
+        std::unordered_map<std::string, uint32_t> index_;
+};
+
+}
+
+#endif // COMPACT_GRAPH_H_
@@ -0,0 +1,56 @@
+#ifndef GRAPH_COMPONENTS_H_
+#define GRAPH_COMPONENTS_H_
+
+#include <cstdint>
+#include <vector>
+#include "impl/compact_graph.h"
+
+namespace routing {
+
+// Disjoint sets over dense ids, with union by size and path halving.
+class UnionFind {
+    public:
+        explicit UnionFind(uint32_t count);
+
+        uint32_t Find(uint32_t id);
+        // Returns false if a and b already were in the same set.
+        bool Union(uint32_t a, uint32_t b);
+        uint32_t SetSize(uint32_t id) { return size_[Find(id)]; }
+
+    private:
+        std::vector<uint32_t> parent_;
+        std::vector<uint32_t> size_;
+};
+
+// Component label of every node of a CompactGraph. Labels are dense and
+// numbered in order of the lowest node index in each component. Both
+// labelers are iterative, so long chains cannot overflow the stack.
+class GraphComponents {
+    public:
+        // Components with every edge taken as undirected.
+        static GraphComponents Connected(const CompactGraph& graph);
+        // Sets of nodes that can all reach each other along the edge
+        // directions (Tarjan's algorithm).
+        static GraphComponents StronglyConnected(const CompactGraph& graph);
+
+        uint32_t Count() const { return static_cast<uint32_t>(sizes_.size()); }
+        uint32_t Label(uint32_t node) const { return labels_[node]; }
+        uint32_t Size(uint32_t component) const { return sizes_[component]; }
+        // The component with the most nodes, ties go to the lower label.
+        // Returns kInvalidNode for an empty graph.
+        uint32_t Largest() const;
+        // One entry per node, set for the nodes of component. Can be passed
+        // to CompactGraph::Subgraph.
+        std::vector<char> Mask(uint32_t component) const;
+
+    private:
+        // Renumbers temporary ids in order of first appearance.
+        explicit GraphComponents(const std::vector<uint32_t>& ids);
+
+        std::vector<uint32_t> labels_;
+        std::vector<uint32_t> sizes_;
+};
+
+}
+
+#endif // GRAPH_COMPONENTS_H_
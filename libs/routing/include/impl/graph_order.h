@@ -0,0 +1,42 @@
+#ifndef GRAPH_ORDER_H_
+#define GRAPH_ORDER_H_
+
+#include <cstdint>
+#include <vector>
+#include "impl/compact_graph.h"
+
+namespace routing {
+
+enum class NodeOrder {
+    // as the loader numbered them, e.g. by OSM id
+    kFile,
+    // along a Hilbert curve over the ground plane
+    kHilbert,
+    // breadth first, lowest degree first (Cuthill-McKee)
+    kBreadthFirst,
+};
+
+// Node orders that put nodes which are close in the graph close in memory,
+// so searches touch fewer cache lines and pages. Each order lists the old
+// index of every node in its new position and can be passed to
+// CompactGraph::Renumbered.
+class GraphOrder {
+    public:
+        static std::vector<uint32_t> Compute(const CompactGraph& graph, NodeOrder order);
+
+        // Sorts by the position of each node on a Hilbert curve through a
+        // 2^16 x 2^16 grid over the x, z extent of the graph.
+        static std::vector<uint32_t> Hilbert(const CompactGraph& graph);
+        // Breadth first over the edges taken as undirected, visiting the
+        // neighbors of a node by increasing degree. Each component starts
+        // at its lowest degree node.
+        static std::vector<uint32_t> BreadthFirst(const CompactGraph& graph);
+
+        // Mean of |from - to| over all edges, the usual measure of how far
+        // apart an order keeps neighbors.
+        static double MeanEdgeSpan(const CompactGraph& graph);
+};
+
+}
+
+#endif // GRAPH_ORDER_H_
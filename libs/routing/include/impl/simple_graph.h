@@ -15,6 +15,7 @@ public:
 	const std::string& GetName() const { return name; }
 	const std::vector<IGraphNode*>& GetNeighbors() const { return neighbors; }
 	const std::vector<float> GetPosition() const { return position; }
+	Point3 GetPoint() const { return Point3::FromVec(position); }
     void AddNeighbor(IGraphNode* neighbor) { neighbors.push_back(neighbor); }
 
 private:
@@ -35,9 +36,11 @@ public:
     void AddNode(SimpleGraphNode* node) { 
         nodes.push_back(node);
         nodeMap[node->GetName()] = node; 
+        InvalidateCompactGraph();
     }
     void AddEdge(const std::string& a, const std::string& b) {
         nodeMap[a]->AddNeighbor(nodeMap[b]);
+        InvalidateCompactGraph();
     }
 
 private:
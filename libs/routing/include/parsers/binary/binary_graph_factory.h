@@ -0,0 +1,25 @@
+#ifndef BINARY_GRAPH_FACTORY_H_
+#define BINARY_GRAPH_FACTORY_H_
+
+#include "graph_factory.h"
+#include "parsers/binary/graph_file.h"
+
+namespace routing {
+
+class BinaryGraphFactory : public IGraphFactory {
+public:
+	virtual ~BinaryGraphFactory() {}
+	virtual IGraph* Create(const std::string& file) const {
+		const std::string extension = GraphFile::kExtension;
+		if (file.size() < extension.size() ||
+		    file.compare(file.size() - extension.size(), extension.size(), extension) != 0) {
+			return NULL;
+		}
+
+		return GraphFile::Map(file);
+	}
+};
+
+}
+
+#endif
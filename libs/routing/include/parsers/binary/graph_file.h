@@ -0,0 +1,60 @@
+#ifndef GRAPH_FILE_H_
+#define GRAPH_FILE_H_
+
+#include <cstdint>
+#include <string>
+#include "impl/compact_graph.h"
+
+namespace routing {
+
+// Binary CompactGraph format that is loaded by mapping the file into memory
+// instead of parsing it. All values are stored in the byte order of the
+// machine that wrote the file, which is checked through the magic number.
+//
+// The file starts with a Header, followed by these sections, each starting
+// on an 8 byte boundary:
+//   positions    float[3 * numNodes]     x, y, z of every node
+//   offsets      uint32_t[numNodes + 1]  CSR row offsets
+//   targets      uint32_t[numEdges]      CSR edge targets
+//   lengths      float[numEdges]         euclidean edge lengths
+//   nameOffsets  uint32_t[numNodes + 1]  node name n is the bytes in
+//                                        [nameOffsets[n], nameOffsets[n+1])
+//   names        char[namesSize]         node names, the OSM ids for OSM maps
+// The position, edge and length arrays are used in place, so processes that
+// load the same file share its pages.
+class GraphFile {
+    public:
+        static constexpr uint32_t kMagic = 0x48505247;  // "GRPH"
+        static constexpr uint32_t kVersion = 1;
+        static const char* const kExtension;  // ".rgraph"
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t numNodes;
+            uint32_t numEdges;
+            // bounding box of the positions, checked when mapping
+            float boundsMin[3];
+            float boundsMax[3];
+            uint64_t namesSize;
+            // byte offsets of the sections from the start of the file
+            uint64_t positions;
+            uint64_t offsets;
+            uint64_t targets;
+            uint64_t lengths;
+            uint64_t nameOffsets;
+            uint64_t names;
+        };
+
+        // Writes the euclidean edge lengths, so runtime edge changes of
+        // graph are not saved. Throws runtime_error if the file cannot be
+        // written.
+        static void Write(const CompactGraph& graph, const std::string& filename);
+        // Throws runtime_error if the file cannot be mapped or is not a
+        // valid graph file of this version.
+        static CompactGraph* Map(const std::string& filename);
+};
+
+}
+
+#endif // GRAPH_FILE_H_
@@ -3,6 +3,7 @@
 
 #include "graph.h"
 #include "impl/simple_graph.h"
+#include "impl/compact_graph.h"
 #include <map>
 #include <vector>
 
@@ -10,7 +11,15 @@ namespace routing {
 
 class ObjGraph : public SimpleGraph {
 public:
+	// Triangles with plain vertex indices only.
 	ObjGraph(const std::string& file);
+
+	// Parses the mapped file in one pass. Faces may be polygons with v,
+	// v/vt, v//vn or v/vt/vn corners; every polygon side becomes one edge
+	// in each direction, however many faces share it. Vertex i is named
+	// "i", counting from 1, at (x, z, -y). Throws runtime_error if the
+	// file cannot be read.
+	static CompactGraph* LoadCompactGraphFromFile(const std::string& file);
 };
 
 }
@@ -14,7 +14,7 @@ public:
 			return NULL;
 		}
 
-		return new ObjGraph(file);
+		return ObjGraph::LoadCompactGraphFromFile(file);
 	}
 };
 
@@ -27,6 +27,7 @@ class OSMNode: public IGraphNode {
         const std::vector<float> GetPosition() const override {
             return loc_.toVec();
         }
+        Point3 GetPoint() const override { return loc_; }
     private:
         string name_;
         Point3 loc_;
@@ -8,6 +8,7 @@
 
 #include "util/xml/pugixml.h"
 #include "parsers/osm/osm_graph.h"
+#include "impl/compact_graph.h"
 
 using std::string;
 using std::unordered_map;
@@ -19,7 +20,10 @@ namespace routing {
 class OsmParser {
 public:
   static OSMGraph* LoadGraphFromFile(string filename, bool debug);
+  static CompactGraph* LoadCompactGraphFromFile(string filename, bool debug);
 private:
+  friend class OsmStreamParser;
+
   static OSMGraph* read_nodes(pugi::xml_document* doc, bool debug = false);
   static void read_adjacencies_to(OSMGraph* graph, pugi::xml_document* doc, bool debug=false);
   static unordered_map<string, set<string>> get_adjacency_list_from_file(pugi::xml_document* doc, bool debug = false);
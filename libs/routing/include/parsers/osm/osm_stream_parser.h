@@ -0,0 +1,60 @@
+#ifndef OSM_STREAM_PARSER_H_
+#define OSM_STREAM_PARSER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "impl/compact_graph.h"
+
+namespace routing {
+
+// Reads OSM XML in a single pass over fixed size chunks of the file instead
+// of building a DOM. Only the id and coordinates of every node and the
+// consecutive node pairs of highway ways are kept, in flat arrays, so memory
+// stays a small multiple of the node count even for metro sized extracts.
+//
+// Produces the same graph as OsmParser::LoadGraphFromFile: the largest
+// connected component of the highway network, with OSM ids as node names
+// and the same projection. Nodes are numbered in increasing id order.
+class OsmStreamParser {
+public:
+    // Throws runtime_error if the file cannot be read.
+    static CompactGraph* LoadCompactGraphFromFile(const std::string& filename, bool debug = false);
+    // Same graph, built on threads threads (0 for one per hardware thread).
+    // The mapped file is tokenized in chunks, node ids are resolved through
+    // a hash table sharded by id and the adjacency is built by parallel
+    // sorting.
+    static CompactGraph* ParallelLoadCompactGraphFromFile(const std::string& filename, unsigned threads = 0,
+                                                          bool debug = false);
+
+    // What a pass over the file collects.
+    struct Extract {
+        struct Node {
+            int64_t id;
+            float lat;
+            float lon;
+        };
+        bool hasBounds = false;
+        float minlat = 0, minlon = 0, maxlat = 0, maxlon = 0;
+        // projection center, from the bounds or else the node extent
+        float centerLat = 0, centerLon = 0;
+        std::vector<Node> nodes;
+        // consecutive <nd> refs of highway ways
+        std::vector<std::pair<int64_t, int64_t> > segments;
+    };
+
+    // Turns the collected nodes and segments into the graph.
+    static CompactGraph* BuildGraph(Extract& extract, bool debug = false);
+
+private:
+    class Reader;
+
+    static void center(Extract& extract, const std::vector<char>* include);
+    static void project(const Extract& extract, const Extract::Node& node, float* position);
+};
+
+}
+
+#endif // OSM_STREAM_PARSER_H_
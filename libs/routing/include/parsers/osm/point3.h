@@ -22,6 +22,13 @@ struct Point3 {
     p[2] = arr[2];
   }
 
+  // Missing components are 0.
+  static Point3 FromVec(const std::vector<float>& arr) {
+    return Point3(arr.size() > 0 ? arr[0] : 0.0f,
+                  arr.size() > 1 ? arr[1] : 0.0f,
+                  arr.size() > 2 ? arr[2] : 0.0f);
+  }
+
   float operator[](int index) const { return p[index]; }
 
   bool operator==(const Point3& other) {
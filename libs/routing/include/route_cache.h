@@ -0,0 +1,103 @@
+#ifndef ROUTE_CACHE_H_
+#define ROUTE_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace routing {
+
+class CompactGraph;
+class IGraphNode;
+class RoutingStrategy;
+
+// Immutable position path handed out by the route cache. Holders share
+// the buffer instead of copying it.
+typedef std::shared_ptr<const std::vector<std::vector<float> > > SharedPath;
+
+struct RouteCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    // routes dropped because of edge changes
+    uint64_t invalidations = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Thread safe LRU map from (start node, end node, strategy) to the path
+// between them. Strategies are told apart by address, so a cache must be
+// cleared before a strategy it has seen is destroyed and another one could
+// take its place. Every entry also lists the edges of its route, so an edge
+// change only drops the routes it can affect.
+class RouteCache {
+    public:
+        explicit RouteCache(size_t capacity) : capacity_(capacity) {}
+
+        // Applies the edge changes of graph since the last call: drops the
+        // routes across an edge that got more expensive or was closed, and
+        // every route once an edge got cheaper or was opened, since any of
+        // them may have a shorter alternative now. Switching to another
+        // graph drops everything. Cheap when nothing changed.
+        void Synchronize(const CompactGraph& graph);
+
+        // Returns nullptr on a miss. A hit makes the entry the most recent.
+        SharedPath Find(const IGraphNode* start, const IGraphNode* end,
+                        const RoutingStrategy* strategy);
+        // Replaces any existing entry, evicting the least recently used
+        // one when the cache is full. edges are the edge ids of the route
+        // and version the graph version it was computed at; a route older
+        // than changes the cache has already applied is not stored.
+        void Insert(const IGraphNode* start, const IGraphNode* end,
+                    const RoutingStrategy* strategy, SharedPath path,
+                    std::vector<uint32_t> edges, uint64_t version);
+        // Drops every entry but keeps the counters.
+        void Clear();
+
+        RouteCacheStats GetStats() const;
+
+    private:
+        struct Key {
+            const IGraphNode* start;
+            const IGraphNode* end;
+            const RoutingStrategy* strategy;
+            bool operator==(const Key& other) const {
+                return start == other.start && end == other.end && strategy == other.strategy;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+        struct Entry {
+            Key key;
+            SharedPath path;
+            // sorted, without duplicates
+            std::vector<uint32_t> edges;
+        };
+        typedef std::list<Entry> Entries;
+
+        // Called with mutex_ held.
+        void erase(Entries::iterator entry);
+        void clear();
+
+        mutable std::mutex mutex_;
+        size_t capacity_;
+        // most recently used first
+        Entries entries_;
+        std::unordered_map<Key, Entries::iterator, KeyHash> index_;
+        // the entries whose route uses each edge
+        std::unordered_map<uint32_t, std::vector<Entries::iterator> > byEdge_;
+        const CompactGraph* graph_ = nullptr;
+        uint64_t version_ = 0;
+        uint64_t hits_ = 0;
+        uint64_t misses_ = 0;
+        uint64_t evictions_ = 0;
+        uint64_t invalidations_ = 0;
+};
+
+}
+
+#endif // ROUTE_CACHE_H_
@@ -0,0 +1,45 @@
+#ifndef BIDIRECTIONAL_PATHING_H_
+#define BIDIRECTIONAL_PATHING_H_
+
+#include "routing_strategy.h"
+#include "graph.h"
+#include <string>
+
+namespace routing {
+
+// Grows one frontier forward from the source and one backward from the
+// target over the reverse adjacency, and stops once no shorter meeting point
+// can exist. Edge costs are the euclidean edge lengths. The heuristic, which
+// must be consistent, is applied through average potentials so both sides
+// stay admissible; ZeroDistance gives plain bidirectional Dijkstra.
+class BidirectionalSearch : public RoutingStrategy {
+public:
+	BidirectionalSearch() : heuristic(new EuclideanDistance()) {}
+	explicit BidirectionalSearch(DistanceFunction* heuristic) : heuristic(heuristic) {}
+	~BidirectionalSearch() override;
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const override;
+
+	static const RoutingStrategy& Default() {
+		static BidirectionalSearch bidirectional;
+		return bidirectional;
+	}
+
+private:
+	DistanceFunction* heuristic;
+};
+
+class BidirectionalDijkstra : public BidirectionalSearch {
+public:
+	BidirectionalDijkstra() : BidirectionalSearch(new ZeroDistance()) {}
+	virtual ~BidirectionalDijkstra() {}
+
+	static const RoutingStrategy& Instance() {
+		static BidirectionalDijkstra dijkstra;
+		return dijkstra;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef CONTRACTION_HIERARCHY_H_
+#define CONTRACTION_HIERARCHY_H_
+
+#include "routing_strategy.h"
+#include "impl/compact_graph.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace routing {
+
+class SearchWorkspace;
+
+// Contraction hierarchy over a CompactGraph, using the same node indices.
+// Nodes are contracted in order of importance and every shortest path that
+// ran through a contracted node is preserved by a shortcut edge. A query
+// then only ever walks towards more important nodes from both ends.
+//
+// Upward arcs of node n lead to more important nodes and are used by the
+// forward search. Downward arcs of n come from more important nodes and
+// are walked in reverse by the backward search. Shortcuts remember the
+// node they bypass so paths can be unpacked into original edges.
+class ContractionHierarchy {
+    public:
+        // Edge weights are the euclidean edge lengths of graph.
+        explicit ContractionHierarchy(const CompactGraph& graph);
+
+        // Throws runtime_error if the file cannot be read, was built for a
+        // different graph or does not hold a consistent hierarchy.
+        static ContractionHierarchy* Load(const std::string& filename, const CompactGraph& graph);
+        // Throws runtime_error if the file cannot be written.
+        void Save(const std::string& filename) const;
+
+        // Writes the original node path from source to target into path,
+        // or clears it if target is unreachable. Returns the path length.
+        float ShortestPath(uint32_t source, uint32_t target, std::vector<uint32_t>& path) const;
+
+        // Row-major sources.size() x targets.size() distances, infinite
+        // where unreachable. Every target's upward search space is stored
+        // in buckets that the upward search of every source scans.
+        std::vector<float> DistanceMatrix(const std::vector<uint32_t>& sources,
+                                          const std::vector<uint32_t>& targets) const;
+
+        uint32_t NumNodes() const { return static_cast<uint32_t>(rank_.size()); }
+        uint32_t NumShortcuts() const { return numShortcuts_; }
+        uint32_t Rank(uint32_t node) const { return rank_[node]; }
+
+    private:
+        ContractionHierarchy() = default;
+
+        struct Arc {
+            uint32_t node;
+            float weight;
+            // kInvalidNode for original edges
+            uint32_t middle;
+        };
+
+        // Arcs in compressed sparse row form, like CompactGraph.
+        struct ArcList {
+            std::vector<uint32_t> offsets;
+            std::vector<Arc> arcs;
+            const Arc* Begin(uint32_t node) const { return arcs.data() + offsets[node]; }
+            const Arc* End(uint32_t node) const { return arcs.data() + offsets[node+1]; }
+        };
+
+        void contract(const CompactGraph& graph);
+        // Full search from start over arcs, pruned by stall on demand. The
+        // settled nodes are written to settled; distances stay in ws.
+        void upwardSearch(uint32_t start, const ArcList& arcs, const ArcList& opposite,
+                          SearchWorkspace& ws, std::vector<uint32_t>& settled) const;
+        const Arc* findArc(uint32_t from, uint32_t to) const;
+        // Whether loaded arrays describe a hierarchy queries can run on.
+        bool consistent() const;
+        void unpack(uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+        uint64_t fingerprint_ = 0;
+        uint32_t numShortcuts_ = 0;
+        std::vector<uint32_t> rank_;
+        ArcList up_;
+        ArcList down_;
+};
+
+// Routes on the contraction hierarchy of the graph, building it on first
+// use. Returns the same paths as Dijkstra.
+class ContractionHierarchies : public RoutingStrategy {
+public:
+	virtual ~ContractionHierarchies() {}
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const override;
+
+	static const RoutingStrategy& Default() {
+		static ContractionHierarchies ch;
+		return ch;
+	}
+};
+
+}
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef CUSTOMIZABLE_ROUTING_H_
+#define CUSTOMIZABLE_ROUTING_H_
+
+#include "routing_strategy.h"
+#include "impl/compact_graph.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace routing {
+
+class SearchWorkspace;
+
+// Multi-level partition of a CompactGraph for customizable route planning.
+// Recursive geometric bisection splits the nodes into level 0 cells of at
+// most cellSize nodes. Every level above merges groups of 2^k cells of the
+// level below, with k chosen so the levels use up the whole bisection, so
+// each cell lies in exactly one cell of every higher level. A node is a
+// boundary node of a level if one of its edges leaves its cell there.
+//
+// Only the topology goes in here; edge weights live in an OverlayMetric, so
+// the partition is built once and shared by every metric.
+class OverlayGraph {
+    public:
+        OverlayGraph(const CompactGraph& graph, uint32_t cellSize = 64, int levels = 3);
+
+        const CompactGraph& Graph() const { return *graph_; }
+        int NumLevels() const { return levels_; }
+        uint32_t NumCells(int level) const { return numCells_[level]; }
+        uint32_t Cell(int level, uint32_t node) const {
+            const int shift = level * bits_;
+            return shift < 32 ? code_[node] >> shift : 0;
+        }
+
+        // The boundary nodes of a cell are [BoundaryBegin, BoundaryEnd).
+        const uint32_t* BoundaryBegin(int level, uint32_t cell) const {
+            return boundary_[level].data() + boundaryOffsets_[level][cell];
+        }
+        const uint32_t* BoundaryEnd(int level, uint32_t cell) const {
+            return boundary_[level].data() + boundaryOffsets_[level][cell+1];
+        }
+        uint32_t NumBoundaryNodes(int level, uint32_t cell) const {
+            return boundaryOffsets_[level][cell+1] - boundaryOffsets_[level][cell];
+        }
+        // Position of node among the boundary nodes of its cell, or
+        // kInvalidNode if it is not one.
+        uint32_t BoundarySlot(int level, uint32_t node) const { return slots_[level][node]; }
+
+        // Where the row-major boundary x boundary matrix of a cell starts in
+        // the clique array of its level, and the size of that array.
+        size_t CliqueOffset(int level, uint32_t cell) const { return cliqueOffsets_[level][cell]; }
+        size_t CliqueSize(int level) const { return cliqueOffsets_[level].back(); }
+
+        // Highest level on which the cell of node contains neither source
+        // nor target, or -1 if its level 0 cell contains one of them. A
+        // query relaxes node on that level.
+        int QueryLevel(uint32_t node, uint32_t source, uint32_t target) const;
+
+    private:
+        const CompactGraph* graph_;
+        int levels_;
+        // bisection steps between two levels
+        int bits_ = 1;
+        // bisection path of every node, the level l cell is code >> l * bits
+        std::vector<uint32_t> code_;
+        std::vector<uint32_t> numCells_;
+        std::vector<std::vector<uint32_t> > boundaryOffsets_;
+        std::vector<std::vector<uint32_t> > boundary_;
+        std::vector<std::vector<uint32_t> > slots_;
+        std::vector<std::vector<size_t> > cliqueOffsets_;
+};
+
+// Edge weights over an OverlayGraph and the cliques they induce: for every
+// cell, the shortest distance inside the cell between each pair of its
+// boundary nodes. Level 0 cliques come from searches over the original
+// edges of the cell, higher ones from searches over the cliques and cut
+// edges of the level below, so a query skips whole cells at a time.
+//
+// A metric never changes once built. Reweighting derives a new metric that
+// customizes only the cells containing both ends of a changed edge.
+class OverlayMetric {
+    public:
+        // weights has one entry per edge of the graph; infinity closes an
+        // edge. Customizes every cell.
+        OverlayMetric(std::shared_ptr<const OverlayGraph> overlay, std::vector<float> weights);
+        // previous with the (edge, weight) changes applied.
+        OverlayMetric(const OverlayMetric& previous, const std::vector<std::pair<uint32_t, float> >& changes);
+
+        const OverlayGraph& Overlay() const { return *overlay_; }
+        const std::vector<float>& Weights() const { return weights_; }
+        // Cells the constructor customized, over all levels.
+        uint32_t CustomizedCells() const { return customizedCells_; }
+
+        // Writes the original node path from source to target into path,
+        // or clears it if target is unreachable. Returns the path length.
+        float ShortestPath(uint32_t source, uint32_t target, std::vector<uint32_t>& path) const;
+
+    private:
+        // Calls visit(next, weight) for every arc of node on level, where
+        // level -1 means the original out edges.
+        template <class Visit>
+        void relax(uint32_t node, int level, const Visit& visit) const;
+        // Dijkstra from source inside one cell of level over the arcs of
+        // level - 1, stopping once stop is settled.
+        void cellSearch(int level, uint32_t cell, uint32_t source, uint32_t stop, SearchWorkspace& ws) const;
+        void customize(const std::vector<std::vector<char> >& dirty);
+        // Appends the original nodes after from on the clique arc from -> to
+        // of level.
+        void unpack(int level, uint32_t from, uint32_t to, std::vector<uint32_t>& path) const;
+
+        std::shared_ptr<const OverlayGraph> overlay_;
+        std::vector<float> weights_;
+        std::vector<std::vector<float> > cliques_;
+        uint32_t customizedCells_ = 0;
+};
+
+// Routes on an OverlayMetric of one graph. Edge weights start out as the
+// edge costs of the graph and can be changed at any time; queries that are
+// already running finish on the weights they started with. Edge changes
+// made on the graph itself are customized in by the next query.
+class CustomizableRouting : public RoutingStrategy {
+public:
+	CustomizableRouting(const CompactGraph& graph, uint32_t cellSize = 64, int levels = 3);
+	virtual ~CustomizableRouting() {}
+
+	// Throws invalid_argument for any graph other than the one this was
+	// built for.
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const override;
+
+	// Sets the weight of each edge id, infinity to close it, and customizes
+	// the affected cells again.
+	void SetEdgeWeights(const std::vector<std::pair<uint32_t, float> >& changes);
+	std::shared_ptr<const OverlayMetric> Metric() const;
+
+private:
+	// Metric() after customizing the graph changes it has not seen yet.
+	std::shared_ptr<const OverlayMetric> current() const;
+	// Called with updateMutex held.
+	void apply(const std::vector<std::pair<uint32_t, float> >& changes) const;
+
+	mutable std::mutex updateMutex;
+	mutable std::mutex metricMutex;
+	mutable std::shared_ptr<const OverlayMetric> metric;
+	// graph version the metric includes
+	mutable std::atomic<uint64_t> graphVersion;
+};
+
+}
+
+#endif
@@ -6,16 +6,37 @@
 
 namespace routing {
 
+enum class TraversalOrder {
+	// Fewest edges, what DepthFirstSearch::Default() has always returned.
+	kBreadthFirst,
+	// The path the first open edges of every node lead along, typically
+	// long and winding.
+	kDepthFirst
+};
+
+// Uninformed search that ignores edge costs and only avoids closed edges.
+// Both orders keep their state in the search workspace of the thread and
+// allocate nothing per node.
 class DepthFirstSearch : public RoutingStrategy {
 public:
+	explicit DepthFirstSearch(TraversalOrder order = TraversalOrder::kBreadthFirst) : order(order) {}
 	~DepthFirstSearch() override = default;
 
 	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const override;
 
+	TraversalOrder GetOrder() const { return order; }
+
 	static const RoutingStrategy& Default() {
 		static DepthFirstSearch dfs;
 		return dfs;
 	}
+	static const RoutingStrategy& DepthFirst() {
+		static DepthFirstSearch dfs(TraversalOrder::kDepthFirst);
+		return dfs;
+	}
+
+private:
+	TraversalOrder order;
 };
 
 }
@@ -0,0 +1,26 @@
+#ifndef DISTANCE_MATRIX_H_
+#define DISTANCE_MATRIX_H_
+
+#include "impl/compact_graph.h"
+#include <cstdint>
+#include <vector>
+
+namespace routing {
+
+// Network distances between sets of nodes without building any paths.
+// Costs are the euclidean edge lengths.
+class DistanceMatrix {
+    public:
+        // Row-major sources.size() x targets.size() distances, infinite
+        // where unreachable. Uses the buckets of the graph's contraction
+        // hierarchy when one has been built, and otherwise one Dijkstra
+        // per source, or per target over the reverse edges if there are
+        // fewer targets, that stops once every other end is settled.
+        static std::vector<float> Compute(const CompactGraph& graph,
+                                          const std::vector<uint32_t>& sources,
+                                          const std::vector<uint32_t>& targets);
+};
+
+}
+
+#endif // DISTANCE_MATRIX_H_
@@ -0,0 +1,104 @@
+#ifndef LANDMARKS_H_
+#define LANDMARKS_H_
+
+#include "distance_function.h"
+#include "impl/compact_graph.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace routing {
+
+enum class LandmarkSelection {
+    // Each landmark is the node farthest from the ones already chosen.
+    kFarthest,
+    // Each landmark ends the branch of a shortest path tree where the
+    // current landmarks give the worst bounds (Goldberg and Werneck).
+    kAvoid
+};
+
+// Distances from and to a few landmark nodes, for every node of a
+// CompactGraph, with the edge costs at construction. By the triangle
+// inequality d(v, t) >= d(L, t) - d(L, v) and d(v, t) >= d(v, L) - d(t, L)
+// for every landmark L, which gives A* a far tighter bound on street grids
+// than the straight line distance.
+class Landmarks {
+    public:
+        // seed picks the starting points of the selection.
+        Landmarks(const CompactGraph& graph, int count,
+                  LandmarkSelection selection = LandmarkSelection::kFarthest, unsigned seed = 1);
+
+        const CompactGraph& Graph() const { return *graph_; }
+        // False once an edge got cheaper than it was when the distances
+        // were computed, which can turn the bounds into overestimates.
+        // Closed and more expensive edges keep them valid.
+        bool Current() const { return graph_->LastDecrease() <= version_; }
+        int Count() const { return static_cast<int>(landmarks_.size()); }
+        uint32_t Landmark(int i) const { return landmarks_[i]; }
+
+        // Lower bound on the distance from node to target.
+        float LowerBound(uint32_t node, uint32_t target) const {
+            const float* fromNode = from_.data() + node * landmarks_.size();
+            const float* fromTarget = from_.data() + target * landmarks_.size();
+            const float* toNode = to_.data() + node * landmarks_.size();
+            const float* toTarget = to_.data() + target * landmarks_.size();
+            float bound = 0;
+            for (size_t i = 0; i < landmarks_.size(); i++) {
+                // unreachable landmarks give infinite or nan terms that never win
+                const float forward = fromTarget[i] - fromNode[i];
+                const float backward = toNode[i] - toTarget[i];
+                if (forward > bound && forward < kUnbounded) {
+                    bound = forward;
+                }
+                if (backward > bound && backward < kUnbounded) {
+                    bound = backward;
+                }
+            }
+            return bound;
+        }
+
+    private:
+        static constexpr float kUnbounded = 3.0e38f;
+
+        const CompactGraph* graph_;
+        // graph version the distances were computed at
+        uint64_t version_;
+        std::vector<uint32_t> landmarks_;
+        // node-major: the distances of node n start at n * Count()
+        std::vector<float> from_;
+        std::vector<float> to_;
+};
+
+// ALT heuristic for AStar(cost, heuristic). Only admissible together with
+// the euclidean cost. The search engine evaluates it by node index on the
+// graph the landmarks were built for; on any other graph, and through the
+// position based interface, it looks the positions up in that graph and
+// falls back to the straight line distance for positions that are not
+// nodes of it.
+class LandmarkHeuristic : public DistanceFunction {
+public:
+	explicit LandmarkHeuristic(std::shared_ptr<const Landmarks> landmarks) : landmarks(landmarks) {}
+	virtual ~LandmarkHeuristic() {}
+
+	virtual float Calculate(const std::vector<float>& a, const std::vector<float>& b) const;
+	virtual float Calculate(const float* a, const float* b) const;
+
+	// Never less than the straight line distance, and just that once the
+	// landmarks are no longer current.
+	float Estimate(uint32_t node, uint32_t target) const {
+		const CompactGraph& graph = landmarks->Graph();
+		const float straight = straightLine.Calculate(graph.Position(node), graph.Position(target));
+		return landmarks->Current() ? std::max(landmarks->LowerBound(node, target), straight) : straight;
+	}
+
+	const Landmarks& GetLandmarks() const { return *landmarks; }
+
+private:
+	std::shared_ptr<const Landmarks> landmarks;
+	EuclideanDistance straightLine;
+};
+
+}
+
+#endif
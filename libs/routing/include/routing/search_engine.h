@@ -0,0 +1,228 @@
+#ifndef SEARCH_ENGINE_H_
+#define SEARCH_ENGINE_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <chrono>
+#include "distance_function.h"
+#include "search_budget.h"
+#include "impl/compact_graph.h"
+
+namespace routing {
+
+// Binary min-heap of node ids with decrease-key. Positions are kept per
+// node, so Clear() only touches the nodes still in the heap.
+class IndexedHeap {
+    public:
+        // Only ever grows.
+        void Resize(uint32_t numNodes);
+        void Clear();
+
+        bool Empty() const { return items_.empty(); }
+        size_t Size() const { return items_.size(); }
+        bool Contains(uint32_t node) const { return position_[node] != kNotInHeap; }
+        float TopKey() const { return items_.front().key; }
+        uint32_t Top() const { return items_.front().node; }
+
+        // Inserts node, or lowers its key if it is already queued. A key
+        // that is not lower than the queued one is ignored.
+        void Push(uint32_t node, float key);
+        uint32_t Pop();
+
+    private:
+        static constexpr uint32_t kNotInHeap = UINT32_MAX;
+        struct Item {
+            float key;
+            uint32_t node;
+        };
+
+        void siftUp(size_t i);
+        void siftDown(size_t i);
+        void place(size_t i, const Item& item) {
+            items_[i] = item;
+            position_[item.node] = static_cast<uint32_t>(i);
+        }
+
+        std::vector<Item> items_;
+        std::vector<uint32_t> position_;
+};
+
+// Per query state keyed by node index. Distances and parents are only valid
+// for nodes stamped with the current generation, so Reset() is O(1) once the
+// arrays have grown to the size of the graph.
+class SearchWorkspace {
+    public:
+        // Searches that need more than one frontier use separate slots.
+        static constexpr int kSlots = 2;
+        static SearchWorkspace& ForCurrentThread(int slot = 0);
+
+        void Reset(uint32_t numNodes);
+
+        bool Reached(uint32_t node) const { return reached_[node] == generation_; }
+        bool Settled(uint32_t node) const { return settled_[node] == generation_; }
+        float Distance(uint32_t node) const {
+            return Reached(node) ? distance_[node] : std::numeric_limits<float>::infinity();
+        }
+        // kInvalidNode for the source and for unreached nodes.
+        uint32_t Parent(uint32_t node) const {
+            return Reached(node) ? parent_[node] : CompactGraph::kInvalidNode;
+        }
+
+        void Reach(uint32_t node, float distance, uint32_t parent) {
+            reached_[node] = generation_;
+            distance_[node] = distance;
+            parent_[node] = parent;
+        }
+        void Settle(uint32_t node) {
+            settled_[node] = generation_;
+            settledCount_++;
+        }
+        uint32_t SettledCount() const { return settledCount_; }
+
+        // Limits every search on this workspace until ClearBudget(). The
+        // searches poll Exhausted() once per settled node and give up when
+        // it returns true; extraSettled counts the nodes a search settled
+        // in another workspace. Reset() keeps the budget and its clock;
+        // SetBudget() also forgets why the last search stopped.
+        void SetBudget(const SearchBudget& budget);
+        void ClearBudget() { budget_ = SearchBudget(); limited_ = false; }
+        bool Exhausted(uint32_t extraSettled = 0) { return limited_ && exhausted(extraSettled); }
+        // Whether the last search gave up, and why.
+        bool Stopped() const { return stop_ != RouteStatus::kFound; }
+        RouteStatus StopReason() const { return stop_; }
+
+        IndexedHeap& Heap() { return heap_; }
+        std::vector<uint32_t>& Queue() { return queue_; }
+
+        // Follows the parents back from node and writes the path, source
+        // first, into path.
+        void PathTo(uint32_t node, std::vector<uint32_t>& path) const;
+
+    private:
+        bool exhausted(uint32_t extraSettled);
+
+        uint32_t generation_ = 0;
+        uint32_t settledCount_ = 0;
+        SearchBudget budget_;
+        bool limited_ = false;
+        uint32_t polls_ = 0;
+        std::chrono::steady_clock::time_point start_;
+        RouteStatus stop_ = RouteStatus::kFound;
+        std::vector<uint32_t> reached_;
+        std::vector<uint32_t> settled_;
+        std::vector<float> distance_;
+        std::vector<uint32_t> parent_;
+        IndexedHeap heap_;
+        std::vector<uint32_t> queue_;
+};
+
+// Edge cost and heuristic callables that evaluate a distance policy on node
+// positions. A euclidean cost reads the edge lengths instead, so it also
+// sees edge weights; the others only see closed edges.
+template <class Policy>
+struct PolicyEdgeCost {
+    const CompactGraph& graph;
+    float operator()(uint32_t from, uint32_t edge) const {
+        if (!graph.EdgeOpen(edge)) {
+            return std::numeric_limits<float>::infinity();
+        }
+        return Policy::Between(graph.Position(from), graph.Position(graph.EdgeTarget(edge)));
+    }
+};
+
+template <>
+struct PolicyEdgeCost<EuclideanPolicy> {
+    const CompactGraph& graph;
+    float operator()(uint32_t, uint32_t edge) const { return graph.EdgeLength(edge); }
+};
+
+template <class Policy>
+struct PolicyEstimate {
+    const CompactGraph& graph;
+    const float* target;
+    float operator()(uint32_t node) const { return Policy::Between(graph.Position(node), target); }
+};
+
+// Index based searches shared by the routing strategies. Each returns
+// whether target was reached; the path is read back from the workspace.
+// All of them stop early once the budget of the workspace runs out.
+class SearchEngine {
+    public:
+        // A* with edge costs from cost and the estimate to target from
+        // heuristic. A euclidean cost uses the precomputed edge lengths.
+        static bool ShortestPath(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                 const DistanceFunction& cost, const DistanceFunction& heuristic,
+                                 SearchWorkspace& workspace);
+
+        // Same search with the metrics fixed at compile time, see
+        // distance_policy.h. Nothing in the loop is a virtual call.
+        template <class CostPolicy, class HeuristicPolicy>
+        static bool ShortestPath(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                 SearchWorkspace& workspace) {
+            workspace.Reset(graph.NumNodes());
+            return AStarSearch(graph, source, target, PolicyEdgeCost<CostPolicy>{graph},
+                               PolicyEstimate<HeuristicPolicy>{graph, graph.Position(target)}, workspace);
+        }
+
+        // The A* loop both of the above run. cost(node, edge) is the cost of
+        // an out edge of node and estimate(node) the heuristic to target.
+        // The workspace must have been reset for this graph.
+        template <class Cost, class Estimate>
+        static bool AStarSearch(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                const Cost& cost, const Estimate& estimate, SearchWorkspace& workspace);
+
+        // Fewest edges first; stops as soon as target is discovered.
+        static bool BreadthFirst(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                 SearchWorkspace& workspace);
+        // Follows the first unvisited open edge of every node as deep as it
+        // goes and backtracks from dead ends; stops as soon as target is
+        // discovered. The stack lives in the workspace queue and holds one
+        // edge cursor per node on the current path.
+        static bool DepthFirst(const CompactGraph& graph, uint32_t source, uint32_t target,
+                               SearchWorkspace& workspace);
+
+        // Looks up both names, throwing invalid_argument like the
+        // strategies always have, and converts a node path back to names.
+        static uint32_t RequireNode(const CompactGraph& graph, const std::string& name,
+                                    const std::string& role);
+        static std::vector<std::string> ToNames(const CompactGraph& graph,
+                                                const std::vector<uint32_t>& path);
+};
+
+template <class Cost, class Estimate>
+bool SearchEngine::AStarSearch(const CompactGraph& graph, uint32_t source, uint32_t target,
+                               const Cost& cost, const Estimate& estimate, SearchWorkspace& ws) {
+    IndexedHeap& open = ws.Heap();
+    ws.Reach(source, 0, CompactGraph::kInvalidNode);
+    open.Push(source, estimate(source));
+
+    while (!open.Empty()) {
+        const uint32_t node = open.Pop();
+        ws.Settle(node);
+        if (node == target) {
+            return true;
+        }
+        if (ws.Exhausted()) {
+            return false;
+        }
+
+        const float distance = ws.Distance(node);
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t next = graph.EdgeTarget(e);
+            if (ws.Settled(next)) {
+                continue;
+            }
+            const float candidate = distance + cost(node, e);
+            if (candidate < ws.Distance(next)) {
+                ws.Reach(next, candidate, node);
+                open.Push(next, candidate + estimate(next));
+            }
+        }
+    }
+    return false;
+}
+
+}
+
+#endif // SEARCH_ENGINE_H_
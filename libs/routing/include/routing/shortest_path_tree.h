@@ -0,0 +1,61 @@
+#ifndef SHORTEST_PATH_TREE_H_
+#define SHORTEST_PATH_TREE_H_
+
+#include "impl/compact_graph.h"
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace routing {
+
+// One-to-all Dijkstra result over the euclidean edge lengths, kept as flat
+// arrays indexed by node so every lookup is O(1). Nodes are also listed in
+// order of distance, which answers isochrone queries with a binary search.
+class ShortestPathTree {
+    public:
+        // Searches the whole graph, or stops at maxDistance; nodes farther
+        // away count as unreachable. A reverse tree follows the in edges
+        // and so holds distances to source instead of from it.
+        ShortestPathTree(const CompactGraph& graph, uint32_t source,
+                         float maxDistance = std::numeric_limits<float>::infinity(),
+                         bool reverse = false);
+
+        uint32_t Source() const { return source_; }
+        bool IsReverse() const { return reverse_; }
+        uint32_t NumNodes() const { return static_cast<uint32_t>(distance_.size()); }
+
+        // Infinite for unreachable nodes.
+        float Distance(uint32_t node) const { return distance_[node]; }
+        bool Reachable(uint32_t node) const {
+            return distance_[node] != std::numeric_limits<float>::infinity();
+        }
+        // Neighbor one step closer to the source, kInvalidNode for the
+        // source itself and for unreachable nodes.
+        uint32_t Parent(uint32_t node) const { return parent_[node]; }
+
+        const std::vector<float>& Distances() const { return distance_; }
+        const std::vector<uint32_t>& Parents() const { return parent_; }
+        // Reachable nodes, closest first.
+        const std::vector<uint32_t>& Order() const { return order_; }
+
+        // Nodes at most distance away, closest first.
+        std::vector<uint32_t> Within(float distance) const;
+        std::vector<uint32_t> WithinTime(float seconds, float speed) const {
+            return Within(seconds * speed);
+        }
+
+        // Tree path in travel direction: from the source to node, or from
+        // node to the source in a reverse tree. Empty if unreachable.
+        std::vector<uint32_t> Path(uint32_t node) const;
+
+    private:
+        uint32_t source_;
+        bool reverse_;
+        std::vector<float> distance_;
+        std::vector<uint32_t> parent_;
+        std::vector<uint32_t> order_;
+};
+
+}
+
+#endif // SHORTEST_PATH_TREE_H_
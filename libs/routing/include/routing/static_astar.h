@@ -0,0 +1,46 @@
+#ifndef STATIC_ASTAR_H_
+#define STATIC_ASTAR_H_
+
+#include "routing_strategy.h"
+#include "graph.h"
+#include "distance_policy.h"
+#include "routing/search_engine.h"
+#include <string>
+#include <vector>
+
+namespace routing {
+
+// AStar with the edge cost and the heuristic fixed at compile time as
+// distance policies. Finds the same paths as AStar constructed with the
+// matching PolicyDistance objects, but the search loop is fully inlined.
+template <class CostPolicy, class HeuristicPolicy>
+class StaticAStar : public RoutingStrategy {
+public:
+	virtual ~StaticAStar() {}
+
+	std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const override {
+		const CompactGraph& compact = *graph->GetCompactGraph();
+		const uint32_t source = SearchEngine::RequireNode(compact, from, "from");
+		const uint32_t target = SearchEngine::RequireNode(compact, to, "to");
+
+		SearchWorkspace& workspace = SearchWorkspace::ForCurrentThread();
+		std::vector<uint32_t> path;
+		if (SearchEngine::ShortestPath<CostPolicy, HeuristicPolicy>(compact, source, target, workspace)) {
+			workspace.PathTo(target, path);
+		}
+		return SearchEngine::ToNames(compact, path);
+	}
+
+	static const RoutingStrategy& Default() {
+		static StaticAStar astar;
+		return astar;
+	}
+};
+
+// Dijkstra is A* without a heuristic.
+template <class CostPolicy>
+using StaticDijkstra = StaticAStar<CostPolicy, ZeroPolicy>;
+
+}
+
+#endif
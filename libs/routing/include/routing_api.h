@@ -1,21 +1,61 @@
 #ifndef ROUTING_API_H_
 #define ROUTING_API_H_
 
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "graph_factory.h"
+#include "impl/graph_order.h"
 
 namespace routing {
 
+class ThreadPool;
+
+// One query of a batch, answered like IGraph::GetSharedPath(src, dest,
+// *strategy).
+struct PathRequest {
+    std::vector<float> src;
+    std::vector<float> dest;
+    const RoutingStrategy* strategy;
+};
+
 class RoutingAPI {
 public:
     RoutingAPI();
 	virtual ~RoutingAPI();
     virtual IGraph* LoadFromFile(const std::string& file) const;
     virtual void AddFactory(const IGraphFactory* factory);
+    // Node order of the graphs LoadFromFile returns from now on, kFile
+    // (the default) to keep the order of the loader. Renumbering copies
+    // the arrays, so binary graph files are better written in the order
+    // they should be used in.
+    virtual void SetNodeOrder(NodeOrder order) { nodeOrder = order; }
+
+    // Number of threads the batch queries run on, 0 for one per hardware
+    // thread (the default). Must not be called while a batch is in flight.
+    virtual void SetThreads(unsigned count);
+    // Resolves all requests concurrently and returns the paths in request
+    // order. The calling thread is one of the threads, so this blocks until
+    // the batch is done. Rethrows the first exception a query threw.
+    virtual std::vector<SharedPath> GetPaths(const IGraph* graph,
+                                             const std::vector<PathRequest>& requests);
+    // Queues the requests and returns at once. The pool threads other than
+    // the caller work on them, so with a single thread the queries run
+    // before this returns. graph and the strategies must outlive the
+    // futures and the graph must not be modified meanwhile.
+    virtual std::vector<std::future<SharedPath> > SubmitPaths(const IGraph* graph,
+                                                              std::vector<PathRequest> requests);
 
 private:
+    ThreadPool& pool();
+
     std::vector<const IGraphFactory*> factories;
+    std::mutex poolMutex;
+    unsigned threads = 0;
+    NodeOrder nodeOrder = NodeOrder::kFile;
+    std::unique_ptr<ThreadPool> threadPool;
 };
 
 }
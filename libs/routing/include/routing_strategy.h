@@ -4,15 +4,30 @@
 #include <vector>
 #include <string>
 #include "graph.h"
+#include "search_budget.h"
 
 namespace routing {
 
 class IGraph;
 
+struct RouteResult {
+	RouteStatus status = RouteStatus::kUnreachable;
+	// The path for kFound and empty for kUnreachable. When the budget ran
+	// out it is the best the search got: a complete path if it already had
+	// one, else the path from "from" to the reached node nearest "to".
+	std::vector<std::string> path;
+};
+
 class RoutingStrategy {
 public:
 	virtual ~RoutingStrategy() {}
 	virtual std::vector<std::string> GetPath(const IGraph* graph, const std::string& from, const std::string& to) const = 0;
+
+	// GetPath() within budget. The searches on the thread's search
+	// workspace (A*, Dijkstra, breadth and depth first, bidirectional)
+	// stop when it runs out; other strategies always finish.
+	virtual RouteResult GetRoute(const IGraph* graph, const std::string& from, const std::string& to,
+	                             const SearchBudget& budget) const;
 };
 
 }
@@ -0,0 +1,31 @@
+#ifndef SEARCH_BUDGET_H_
+#define SEARCH_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+
+namespace routing {
+
+// How a route query ended.
+enum class RouteStatus {
+    kFound,
+    kUnreachable,
+    // ran out of settled nodes or time
+    kBudgetExceeded,
+    kCancelled,
+};
+
+// Limits of one route query, checked once per settled node, the clock only
+// every few dozen. A zero limit is no limit.
+struct SearchBudget {
+    uint32_t maxSettled = 0;
+    double maxMilliseconds = 0;
+    // the query gives up once this is set, from any thread
+    const std::atomic<bool>* cancel = nullptr;
+
+    bool Unlimited() const { return maxSettled == 0 && maxMilliseconds <= 0 && cancel == nullptr; }
+};
+
+}
+
+#endif // SEARCH_BUDGET_H_
@@ -0,0 +1,56 @@
+#ifndef SPATIAL_INDEX_H_
+#define SPATIAL_INDEX_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace routing {
+
+// Static k-d tree over packed x, y, z positions. Point ids are the index of
+// the point in the array given to the constructor. Ties are broken towards
+// the lower id so results match a linear scan over the same points.
+class SpatialIndex {
+    public:
+        static constexpr uint32_t kNone = UINT32_MAX;
+
+        SpatialIndex() = default;
+        explicit SpatialIndex(const std::vector<float>& positions);
+        SpatialIndex(const float* positions, uint32_t count);
+
+        uint32_t Size() const { return static_cast<uint32_t>(ids_.size()); }
+
+        // Returns kNone if the index is empty.
+        uint32_t Nearest(const float point[3]) const;
+        // Up to k ids, closest first.
+        std::vector<uint32_t> KNearest(const float point[3], uint32_t k) const;
+        // All ids within radius (inclusive), closest first.
+        std::vector<uint32_t> WithinRadius(const float point[3], float radius) const;
+
+    private:
+        struct Candidate {
+            float distance2;
+            uint32_t id;
+            bool operator<(const Candidate& other) const {
+                return distance2 < other.distance2 ||
+                    (distance2 == other.distance2 && id < other.id);
+            }
+        };
+
+        void build(uint32_t lo, uint32_t hi);
+        void nearest(uint32_t lo, uint32_t hi, const float point[3], Candidate& best) const;
+        void kNearest(uint32_t lo, uint32_t hi, const float point[3], uint32_t k,
+                      std::vector<Candidate>& heap) const;
+        void withinRadius(uint32_t lo, uint32_t hi, const float point[3], float radius2,
+                          std::vector<Candidate>& out) const;
+        float distance2(uint32_t slot, const float point[3]) const;
+
+        // Tree order: the median of every range [lo, hi) is its root, split
+        // along axes_[median].
+        std::vector<float> points_;
+        std::vector<uint32_t> ids_;
+        std::vector<uint8_t> axes_;
+};
+
+}
+
+#endif // SPATIAL_INDEX_H_
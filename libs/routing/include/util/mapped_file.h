@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace routing {
+
+// Read only private mapping of a whole file, unmapped on destruction.
+class MappedFile {
+    public:
+        // Throws runtime_error if the file cannot be opened or mapped.
+        explicit MappedFile(const std::string& filename);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* Data() const { return static_cast<const char*>(data_); }
+        size_t Size() const { return size_; }
+
+    private:
+        void* data_ = NULL;
+        size_t size_ = 0;
+};
+
+}
+
+#endif // MAPPED_FILE_H_
@@ -0,0 +1,40 @@
+#ifndef POLYLINE_H_
+#define POLYLINE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace routing {
+
+// Post-processing for position paths, e.g. from IGraph::GetSharedPath(),
+// before they are followed or sent to a client. Vertices are x, y, z; any
+// missing component counts as 0.
+class Polyline {
+    public:
+        // Indices of the vertices Douglas-Peucker keeps, in order. Every
+        // dropped vertex is within tolerance of the segment between the kept
+        // vertices around it, so the simplified path never strays more than
+        // tolerance from the road. The first and last vertex are always kept.
+        static std::vector<uint32_t> SimplifyIndices(const std::vector<std::vector<float> >& path,
+                                                     float tolerance);
+        // The vertices at SimplifyIndices(path, tolerance).
+        static std::vector<std::vector<float> > Simplify(const std::vector<std::vector<float> >& path,
+                                                         float tolerance);
+
+        // Google's encoded polyline format with three components per vertex:
+        // each component is rounded to 10^-precision, delta encoded against
+        // the previous vertex, zigzag encoded and written 5 bits per
+        // printable ASCII character.
+        static std::string Encode(const std::vector<std::vector<float> >& path, int precision = kPrecision);
+        // Throws invalid_argument if encoded is not a whole number of
+        // vertices.
+        static std::vector<std::vector<float> > Decode(const std::string& encoded, int precision = kPrecision);
+
+        // Graph positions are in scene units, a tenth of one is plenty.
+        static const int kPrecision = 1;
+};
+
+}
+
+#endif // POLYLINE_H_
@@ -0,0 +1,84 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace routing {
+
+// Fixed set of threads that run batches of numbered tasks. The thread that
+// calls Run() works on the batch too, so a pool of size 1 has no workers
+// and runs everything inline.
+class ThreadPool {
+    public:
+        // threads == 0 uses one thread per hardware thread.
+        explicit ThreadPool(unsigned threads = 0);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned Size() const { return static_cast<unsigned>(workers_.size()) + 1; }
+
+        // Calls task(i) for every i in [0, count) and returns once all calls
+        // have finished. Rethrows the first exception a task threw. Must not
+        // be called from inside a task.
+        void Run(size_t count, const std::function<void(size_t)>& task);
+        // Queues task for the workers and returns at once. Workers take
+        // queued tasks between batches; a pool without workers runs task
+        // before returning. task must not throw. The destructor waits for
+        // the queue to drain.
+        void Post(std::function<void()> task);
+
+    private:
+        void work();
+        void workerLoop();
+
+        std::vector<std::thread> workers_;
+        std::mutex runMutex_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(size_t)>* task_ = nullptr;
+        size_t count_ = 0;
+        std::atomic<size_t> next_{0};
+        size_t busy_ = 0;
+        unsigned long generation_ = 0;
+        bool stop_ = false;
+        std::exception_ptr error_;
+        std::deque<std::function<void()> > queue_;
+};
+
+// Stable sort that sorts one slice per pool thread and merges them in
+// parallel rounds.
+template <class T, class Less>
+void ParallelStableSort(ThreadPool& pool, std::vector<T>& values, Less less) {
+    const size_t slices = std::min<size_t>(pool.Size(), std::max<size_t>(values.size() / 1024, 1));
+    std::vector<size_t> bounds(slices + 1);
+    for (size_t i = 0; i <= slices; i++) {
+        bounds[i] = values.size() * i / slices;
+    }
+    pool.Run(slices, [&](size_t i) {
+        std::stable_sort(values.begin() + bounds[i], values.begin() + bounds[i+1], less);
+    });
+    for (size_t width = 1; width < slices; width *= 2) {
+        pool.Run((slices + 2 * width - 1) / (2 * width), [&](size_t pair) {
+            const size_t first = 2 * width * pair;
+            const size_t middle = std::min(first + width, slices);
+            const size_t last = std::min(first + 2 * width, slices);
+            std::inplace_merge(values.begin() + bounds[first], values.begin() + bounds[middle],
+                               values.begin() + bounds[last], less);
+        });
+    }
+}
+
+}
+
+#endif // THREAD_POOL_H_
@@ -1,41 +1,90 @@
 #include "graph.h"
+#include "impl/compact_graph.h"
+#include "routing/distance_matrix.h"
+#include "routing/shortest_path_tree.h"
+#include <algorithm>
 #include <limits>
+#include <typeinfo>
 
 namespace routing {
 
+GraphBase::GraphBase() = default;
+
+GraphBase::~GraphBase() = default;
+
+const CompactGraph* GraphBase::GetCompactGraph() const {
+    std::lock_guard<std::mutex> lock(compactMutex);
+    if (!compact) {
+        compact.reset(CompactGraph::FromGraph(*this));
+    }
+    return compact.get();
+}
+
+void GraphBase::InvalidateCompactGraph() {
+    {
+        std::lock_guard<std::mutex> lock(compactMutex);
+        compact.reset();
+    }
+    std::lock_guard<std::mutex> lock(routeCacheMutex);
+    if (routeCache) {
+        routeCache->Clear();
+    }
+}
+
+void GraphBase::EnableRouteCache(size_t capacity) {
+    std::lock_guard<std::mutex> lock(routeCacheMutex);
+    if (capacity == 0) {
+        routeCache.reset();
+    } else {
+        routeCache = std::make_shared<RouteCache>(capacity);
+    }
+}
+
+RouteCacheStats GraphBase::GetRouteCacheStats() const {
+    std::lock_guard<std::mutex> lock(routeCacheMutex);
+    return routeCache ? routeCache->GetStats() : RouteCacheStats();
+}
+
 BoundingBox GraphBase::GetBoundingBox() const {
     BoundingBox bb;
 
     const std::vector<IGraphNode*>& nodes = GetNodes();
-    
-    for (int i = 0; i < nodes.size(); i++) {
-        std::vector<float> pos = nodes[i]->GetPosition();
-        if (i == 0) {
-            bb.min = pos;
-            bb.max = pos;
-        }
-        else {
-            for (int j = 0; j < pos.size(); j++) {
-                if (bb.min[j] > pos[j]) {
-                    bb.min[j] = pos[j];
-                }
-                if (bb.max[j] < pos[j]) {
-                    bb.max[j] = pos[j];
-                }
-            }
+    if (nodes.empty()) {
+        return bb;
+    }
+
+    Point3 min = nodes[0]->GetPoint();
+    Point3 max = min;
+    for (const IGraphNode* node : nodes) {
+        const Point3 pos = node->GetPoint();
+        for (int j = 0; j < 3; j++) {
+            min.p[j] = std::min(min.p[j], pos[j]);
+            max.p[j] = std::max(max.p[j], pos[j]);
         }
     }
+    bb.min = min.toVec();
+    bb.max = max.toVec();
 
     return bb;
 }
 
 const IGraphNode* GraphBase::NearestNode(std::vector<float> point, const DistanceFunction& distanceFunction) const {
-    const std::vector<IGraphNode*> nodes = GetNodes();
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    // exact types only, a subclass may measure distance differently
+    const bool euclidean = typeid(distanceFunction) == typeid(EuclideanDistance) ||
+                           typeid(distanceFunction) == typeid(PolicyDistance<EuclideanPolicy>);
+    if (point.size() == 3 && euclidean) {
+        // compact graphs keep the node order of GetNodes()
+        uint32_t index = GetCompactGraph()->GetSpatialIndex().Nearest(point.data());
+        return index == SpatialIndex::kNone ? nullptr : nodes[index];
+    }
+
+    point.resize(3, 0.0f);
     float minDistance = std::numeric_limits<float>::infinity();
     const IGraphNode* closestNode = nullptr;
     for (auto* node: nodes) {
-        auto temp_3d = node->GetPosition();
-        float distance = distanceFunction.Calculate(temp_3d, point);
+        const Point3 position = node->GetPoint();
+        float distance = distanceFunction.Calculate(position.p, point.data());
         if (distance < minDistance) {
             closestNode = node;
             minDistance = distance;
@@ -45,22 +94,211 @@ const IGraphNode* GraphBase::NearestNode(std::vector<float> point, const Distanc
     return closestNode;
 }
 
+std::vector<const IGraphNode*> GraphBase::NearestNodes(std::vector<float> point, int k) const {
+    point.resize(3, 0.0f);
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    std::vector<const IGraphNode*> result;
+    for (uint32_t index : GetCompactGraph()->GetSpatialIndex().KNearest(point.data(), k > 0 ? k : 0)) {
+        result.push_back(nodes[index]);
+    }
+    return result;
+}
+
+std::vector<const IGraphNode*> GraphBase::NodesWithinRadius(std::vector<float> point, float radius) const {
+    point.resize(3, 0.0f);
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    std::vector<const IGraphNode*> result;
+    for (uint32_t index : GetCompactGraph()->GetSpatialIndex().WithinRadius(point.data(), radius)) {
+        result.push_back(nodes[index]);
+    }
+    return result;
+}
+
+std::vector< std::vector<float> > GraphBase::GetDistanceMatrix(const std::vector< std::vector<float> >& sources,
+                                                             const std::vector< std::vector<float> >& targets) const {
+    const CompactGraph* compact = GetCompactGraph();
+    auto snap = [compact](const std::vector< std::vector<float> >& points) {
+        std::vector<uint32_t> nodes;
+        nodes.reserve(points.size());
+        for (std::vector<float> point : points) {
+            point.resize(3, 0.0f);
+            nodes.push_back(compact->GetSpatialIndex().Nearest(point.data()));
+        }
+        return nodes;
+    };
+    const std::vector<uint32_t> sourceNodes = snap(sources);
+    const std::vector<uint32_t> targetNodes = snap(targets);
+    if (compact->NumNodes() == 0) {
+        return std::vector< std::vector<float> >(sources.size(),
+            std::vector<float>(targets.size(), std::numeric_limits<float>::infinity()));
+    }
+
+    std::vector<float> distances = DistanceMatrix::Compute(*compact, sourceNodes, targetNodes);
+    std::vector< std::vector<float> > rows;
+    rows.reserve(sources.size());
+    for (size_t row = 0; row < sources.size(); row++) {
+        auto begin = distances.begin() + row * targets.size();
+        rows.emplace_back(begin, begin + targets.size());
+    }
+    return rows;
+}
+
+std::shared_ptr<const ShortestPathTree> GraphBase::GetShortestPathTree(std::vector<float> source) const {
+    source.resize(3, 0.0f);
+    const CompactGraph* compact = GetCompactGraph();
+    uint32_t node = compact->GetSpatialIndex().Nearest(source.data());
+    if (node == SpatialIndex::kNone) {
+        return nullptr;
+    }
+    return std::make_shared<const ShortestPathTree>(*compact, node);
+}
+
+std::vector<const IGraphNode*> GraphBase::GetIsochrone(std::vector<float> source, float distance) const {
+    source.resize(3, 0.0f);
+    const CompactGraph* compact = GetCompactGraph();
+    std::vector<const IGraphNode*> result;
+    uint32_t node = compact->GetSpatialIndex().Nearest(source.data());
+    if (node == SpatialIndex::kNone) {
+        return result;
+    }
+    const std::vector<IGraphNode*>& nodes = GetNodes();
+    const ShortestPathTree tree(*compact, node, distance);
+    for (uint32_t index : tree.Order()) {
+        result.push_back(nodes[index]);
+    }
+    return result;
+}
+
 const std::vector< std::vector<float> > GraphBase::GetPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+    return *GetSharedPath(std::move(src), std::move(dest), pathing);
+}
+
+SharedPath GraphBase::GetSharedPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing) const {
+    return GetSharedPath(std::move(src), std::move(dest), pathing, SearchBudget(), nullptr);
+}
+
+SharedPath GraphBase::GetSharedPath(std::vector<float> src, std::vector<float> dest, const RoutingStrategy& pathing,
+                                    const SearchBudget& budget, RouteStatus* status) const {
     using namespace std;
-    const IGraphNode* start_node = NearestNode(src, EuclideanDistance());
-    const IGraphNode* end_node = NearestNode(dest, EuclideanDistance());
+    const IGraphNode* start_node = NearestNode(std::move(src), EuclideanDistance());
+    const IGraphNode* end_node = NearestNode(std::move(dest), EuclideanDistance());
 
-    vector<string> string_path = pathing.GetPath(this, start_node->GetName(), end_node->GetName());
+    shared_ptr<RouteCache> cache;
+    {
+        lock_guard<mutex> lock(routeCacheMutex);
+        cache = routeCache;
+    }
+    const CompactGraph& compact = *GetCompactGraph();
+    // read before searching, so a change during the search counts as newer
+    const uint64_t version = compact.Version();
+    if (cache) {
+        cache->Synchronize(compact);
+        SharedPath cached = cache->Find(start_node, end_node, &pathing);
+        if (cached) {
+            if (status) {
+                // only complete answers are cached
+                *status = cached->size() > 2 ? RouteStatus::kFound : RouteStatus::kUnreachable;
+            }
+            return cached;
+        }
+    }
+
+    RouteResult route = pathing.GetRoute(this, start_node->GetName(), end_node->GetName(), budget);
+    if (status) {
+        *status = route.status;
+    }
+    const vector<string>& string_path = route.path;
 
-    vector< vector<float> > position_path;
-    position_path.push_back(start_node->GetPosition());
+    auto position_path = make_shared<vector< vector<float> > >();
+    position_path->reserve(string_path.size() + 2);
+    // GetPosition() returns a const vector that push_back would copy
+    auto push = [&position_path](const IGraphNode* node) {
+        const Point3 position = node->GetPoint();
+        position_path->emplace_back(position.p, position.p + 3);
+    };
+    push(start_node);
     for (const auto &string : string_path) {
-        position_path.push_back(this->GetNode(string)->GetPosition());
+        push(this->GetNode(string));
     }
-    position_path.push_back(end_node->GetPosition());
+    push(end_node);
+
+    SharedPath path = std::move(position_path);
+    if (cache && (route.status == RouteStatus::kFound || route.status == RouteStatus::kUnreachable)) {
+        vector<uint32_t> edges;
+        for (size_t i = 1; i < string_path.size(); i++) {
+            edges.push_back(compact.FindEdge(string_path[i-1], string_path[i]));
+        }
+        cache->Insert(start_node, end_node, &pathing, path, std::move(edges), version);
+    }
+    return path;
+}
 
-    return position_path; 
+bool GraphBase::SetEdgeWeight(const std::string& from, const std::string& to, float weight) {
+    GetCompactGraph();
+    std::lock_guard<std::mutex> lock(compactMutex);
+    return compact && compact->SetEdgeWeight(from, to, weight);
 }
 
+bool GraphBase::SetEdgeEnabled(const std::string& from, const std::string& to, bool enabled) {
+    GetCompactGraph();
+    std::lock_guard<std::mutex> lock(compactMutex);
+    return compact && compact->SetEdgeEnabled(from, to, enabled);
 }
 
+uint64_t GraphBase::GetVersion() const {
+    return GetCompactGraph()->Version();
+}
+
+SharedPath GraphBase::RepairPath(const SharedPath& path, size_t from, uint64_t version,
+                                 const RoutingStrategy& strategy) const {
+    using namespace std;
+    const CompactGraph& compact = *GetCompactGraph();
+    vector<uint32_t> changed;
+    for (const EdgeChange& change : compact.ChangesSince(version)) {
+        changed.push_back(change.edge);
+    }
+    if (changed.empty() || !path || from + 1 >= path->size()) {
+        return path;
+    }
+    sort(changed.begin(), changed.end());
+
+    // path vertices are node positions, the first and last one repeated
+    const vector<vector<float> >& points = *path;
+    vector<uint32_t> nodes(points.size(), CompactGraph::kInvalidNode);
+    for (size_t i = from; i < points.size(); i++) {
+        nodes[i] = compact.GetSpatialIndex().Nearest(Point3::FromVec(points[i]).p);
+    }
+    size_t first = points.size(), last = 0;
+    for (size_t i = from; i + 1 < points.size(); i++) {
+        const uint32_t edge = nodes[i] == nodes[i+1] ? CompactGraph::kInvalidEdge
+                                                     : compact.FindEdge(nodes[i], nodes[i+1]);
+        if (edge != CompactGraph::kInvalidEdge && binary_search(changed.begin(), changed.end(), edge)) {
+            first = min(first, i);
+            last = i + 1;
+        }
+    }
+    if (first == points.size()) {
+        return path;
+    }
+
+    vector<string> detour = strategy.GetPath(this, compact.NameOf(nodes[first]), compact.NameOf(nodes[last]));
+    if (detour.empty()) {
+        // last may only have been reachable over the closed edges
+        last = points.size() - 1;
+        detour = strategy.GetPath(this, compact.NameOf(nodes[first]), compact.NameOf(nodes[last]));
+        if (detour.empty()) {
+            return nullptr;
+        }
+    }
+
+    auto repaired = make_shared<vector< vector<float> > >(points.begin(), points.begin() + first);
+    repaired->reserve(first + detour.size() + points.size() - last);
+    for (const string& name : detour) {
+        const Point3 position = compact.PointAt(compact.IndexOf(name));
+        repaired->emplace_back(position.p, position.p + 3);
+    }
+    repaired->insert(repaired->end(), points.begin() + last + 1, points.end());
+    return repaired;
+}
+
+}
@@ -0,0 +1,441 @@
+#include "impl/compact_graph.h"
+#include "routing/contraction_hierarchy.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace routing {
+
+const string& CompactGraphNode::GetName() const {
+    return graph_->NameOf(index_);
+}
+
+const vector<IGraphNode*>& CompactGraphNode::GetNeighbors() const {
+    return graph_->neighborsOf(index_);
+}
+
+const vector<float> CompactGraphNode::GetPosition() const {
+    const float* p = graph_->Position(index_);
+    return vector<float>(p, p + 3);
+}
+
+Point3 CompactGraphNode::GetPoint() const {
+    return graph_->PointAt(index_);
+}
+
+CompactGraph::CompactGraph(vector<string> names, vector<float> positions,
+                           vector<uint32_t> offsets, vector<uint32_t> targets)
+    : names_(std::move(names)), ownedPositions_(std::move(positions)),
+      ownedOffsets_(std::move(offsets)), ownedTargets_(std::move(targets)) {
+    const uint32_t n = NumNodes();
+    if (ownedOffsets_.size() != n + 1 || ownedPositions_.size() != 3 * size_t(n)) {
+        throw invalid_argument("inconsistent compact graph arrays");
+    }
+    positions_ = ownedPositions_.data();
+    offsets_ = ownedOffsets_.data();
+    targets_ = ownedTargets_.data();
+    numEdges_ = static_cast<uint32_t>(ownedTargets_.size());
+
+    ownedLengths_.resize(numEdges_);
+    for (uint32_t node = 0; node < n; node++) {
+        const Point3 from = PointAt(node);
+        for (uint32_t e = EdgeBegin(node); e < EdgeEnd(node); e++) {
+            ownedLengths_[e] = from.distanceBetween(PointAt(targets_[e]));
+        }
+    }
+    lengths_ = ownedLengths_.data();
+
+    init();
+}
+
+CompactGraph::CompactGraph(vector<string> names, const CompactGraphArrays& arrays,
+                           std::shared_ptr<const void> storage)
+    : names_(std::move(names)), positions_(arrays.positions), offsets_(arrays.offsets),
+      targets_(arrays.targets), lengths_(arrays.lengths), numEdges_(arrays.numEdges),
+      storage_(std::move(storage)) {
+    const uint32_t n = NumNodes();
+    if (arrays.numNodes != n || offsets_ == nullptr ||
+        (n > 0 && positions_ == nullptr) || (numEdges_ > 0 && (targets_ == nullptr || lengths_ == nullptr))) {
+        throw invalid_argument("inconsistent compact graph arrays");
+    }
+    init();
+}
+
+CompactGraphArrays CompactGraph::Arrays() const {
+    CompactGraphArrays arrays;
+    arrays.numNodes = NumNodes();
+    arrays.numEdges = numEdges_;
+    arrays.positions = positions_;
+    arrays.offsets = offsets_;
+    arrays.targets = targets_;
+    arrays.lengths = lengths_;
+    return arrays;
+}
+
+void CompactGraph::init() {
+    const uint32_t n = NumNodes();
+    if (offsets_[0] != 0 || offsets_[n] != numEdges_) {
+        throw invalid_argument("inconsistent compact graph arrays");
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        if (offsets_[node] > offsets_[node + 1]) {
+            throw invalid_argument("inconsistent compact graph arrays");
+        }
+    }
+    for (uint32_t e = 0; e < numEdges_; e++) {
+        if (targets_[e] >= n) {
+            throw invalid_argument("inconsistent compact graph arrays");
+        }
+    }
+
+    // counting sort of the edges by target gives the reverse CSR
+    reverseOffsets_.assign(n + 1, 0);
+    for (uint32_t e = 0; e < numEdges_; e++) {
+        reverseOffsets_[targets_[e] + 1]++;
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        reverseOffsets_[node + 1] += reverseOffsets_[node];
+    }
+    reverseSources_.resize(numEdges_);
+    reverseEdges_.resize(numEdges_);
+    vector<uint32_t> fill(reverseOffsets_.begin(), reverseOffsets_.end() - 1);
+    for (uint32_t node = 0; node < n; node++) {
+        for (uint32_t e = EdgeBegin(node); e < EdgeEnd(node); e++) {
+            uint32_t slot = fill[targets_[e]]++;
+            reverseSources_[slot] = node;
+            reverseEdges_[slot] = e;
+        }
+    }
+
+    if (n > 0) {
+        bounds_.min.assign(positions_, positions_ + 3);
+        bounds_.max.assign(positions_, positions_ + 3);
+        for (uint32_t node = 1; node < n; node++) {
+            for (int j = 0; j < 3; j++) {
+                bounds_.min[j] = std::min(bounds_.min[j], positions_[3*size_t(node) + j]);
+                bounds_.max[j] = std::max(bounds_.max[j], positions_[3*size_t(node) + j]);
+            }
+        }
+    }
+
+    spatialIndex_ = SpatialIndex(positions_, n);
+
+    size_t slots = 2;
+    while (slots < 2 * size_t(n)) {
+        slots *= 2;
+    }
+    nameTable_.assign(slots, kInvalidNode);
+    std::hash<string> hash;
+    for (uint32_t node = 0; node < n; node++) {
+        size_t slot = hash(names_[node]) & (slots - 1);
+        while (nameTable_[slot] != kInvalidNode) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        nameTable_[slot] = node;
+    }
+
+    views_.reserve(n);
+    nodes_.reserve(n);
+    for (uint32_t node = 0; node < n; node++) {
+        views_.emplace_back(this, node);
+        nodes_.push_back(&views_.back());
+    }
+}
+
+const vector<IGraphNode*>& CompactGraph::neighborsOf(uint32_t node) const {
+    // only the string API needs these, so graphs that are only searched by
+    // index never allocate them
+    std::call_once(neighborsOnce_, [this]() {
+        neighbors_.resize(NumNodes());
+        for (uint32_t from = 0; from < NumNodes(); from++) {
+            neighbors_[from].reserve(Degree(from));
+            for (uint32_t e = EdgeBegin(from); e < EdgeEnd(from); e++) {
+                neighbors_[from].push_back(nodes_[targets_[e]]);
+            }
+        }
+    });
+    return neighbors_[node];
+}
+
+CompactGraph* CompactGraph::FromGraph(const IGraph& graph) {
+    CompactGraphBuilder builder;
+    const vector<IGraphNode*>& nodes = graph.GetNodes();
+
+    std::unordered_map<const IGraphNode*, uint32_t> ids;
+    ids.reserve(nodes.size());
+    for (const IGraphNode* node : nodes) {
+        ids.insert({node, builder.AddNode(node->GetName(), node->GetPoint())});
+    }
+
+    for (const IGraphNode* node : nodes) {
+        const uint32_t from = ids[node];
+        for (const IGraphNode* other : node->GetNeighbors()) {
+            auto to = ids.find(other);
+            if (to == ids.end()) {
+                throw invalid_argument(other->GetName());
+            }
+            builder.AddEdge(from, to->second);
+        }
+    }
+
+    return builder.Build();
+}
+
+CompactGraph* CompactGraph::Subgraph(const vector<char>& keep) const {
+    const uint32_t n = NumNodes();
+    if (keep.size() != n) {
+        throw invalid_argument("subgraph mask does not match the graph");
+    }
+    vector<uint32_t> index(n, kInvalidNode);
+    vector<string> names;
+    vector<float> positions;
+    for (uint32_t node = 0; node < n; node++) {
+        if (keep[node]) {
+            index[node] = static_cast<uint32_t>(names.size());
+            names.push_back(names_[node]);
+            positions.insert(positions.end(), Position(node), Position(node) + 3);
+        }
+    }
+
+    vector<uint32_t> offsets(1, 0);
+    vector<uint32_t> targets;
+    for (uint32_t node = 0; node < n; node++) {
+        if (!keep[node]) {
+            continue;
+        }
+        for (uint32_t e = EdgeBegin(node); e < EdgeEnd(node); e++) {
+            if (index[targets_[e]] != kInvalidNode) {
+                targets.push_back(index[targets_[e]]);
+            }
+        }
+        offsets.push_back(static_cast<uint32_t>(targets.size()));
+    }
+
+    return new CompactGraph(std::move(names), std::move(positions), std::move(offsets), std::move(targets));
+}
+
+CompactGraph* CompactGraph::Renumbered(const vector<uint32_t>& order) const {
+    const uint32_t n = NumNodes();
+    vector<uint32_t> index(n, kInvalidNode);
+    if (order.size() != n) {
+        throw invalid_argument("node order does not match the graph");
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        if (order[node] >= n || index[order[node]] != kInvalidNode) {
+            throw invalid_argument("node order is not a permutation");
+        }
+        index[order[node]] = node;
+    }
+
+    vector<string> names;
+    vector<float> positions;
+    vector<uint32_t> offsets(1, 0);
+    vector<uint32_t> targets;
+    names.reserve(n);
+    positions.reserve(3 * n);
+    offsets.reserve(n + 1);
+    targets.reserve(NumEdges());
+    for (uint32_t node : order) {
+        names.push_back(names_[node]);
+        positions.insert(positions.end(), Position(node), Position(node) + 3);
+        for (uint32_t e = EdgeBegin(node); e < EdgeEnd(node); e++) {
+            targets.push_back(index[targets_[e]]);
+        }
+        // keep every row sorted by target
+        std::sort(targets.begin() + offsets.back(), targets.end());
+        offsets.push_back(static_cast<uint32_t>(targets.size()));
+    }
+
+    return new CompactGraph(std::move(names), std::move(positions), std::move(offsets), std::move(targets));
+}
+
+const IGraphNode* CompactGraph::GetNode(const string& name) const {
+    uint32_t node = IndexOf(name);
+    return node == kInvalidNode ? NULL : &views_[node];
+}
+
+uint32_t CompactGraph::IndexOf(const string& name) const {
+    const size_t mask = nameTable_.size() - 1;
+    for (size_t slot = std::hash<string>()(name) & mask; nameTable_[slot] != kInvalidNode;
+         slot = (slot + 1) & mask) {
+        if (names_[nameTable_[slot]] == name) {
+            return nameTable_[slot];
+        }
+    }
+    return kInvalidNode;
+}
+
+std::shared_ptr<const ContractionHierarchy> CompactGraph::GetContractionHierarchy() const {
+    std::lock_guard<std::mutex> lock(hierarchyMutex_);
+    if (!hierarchy_) {
+        hierarchy_ = std::make_shared<const ContractionHierarchy>(*this);
+    }
+    return hierarchy_;
+}
+
+std::shared_ptr<const ContractionHierarchy> CompactGraph::FindContractionHierarchy() const {
+    std::lock_guard<std::mutex> lock(hierarchyMutex_);
+    return hierarchy_;
+}
+
+void CompactGraph::SetContractionHierarchy(std::shared_ptr<const ContractionHierarchy> hierarchy) const {
+    std::lock_guard<std::mutex> lock(hierarchyMutex_);
+    hierarchy_ = std::move(hierarchy);
+}
+
+uint32_t CompactGraph::FindEdge(uint32_t from, uint32_t to) const {
+    for (uint32_t e = EdgeBegin(from); e < EdgeEnd(from); e++) {
+        if (targets_[e] == to) {
+            return e;
+        }
+    }
+    return kInvalidEdge;
+}
+
+uint32_t CompactGraph::FindEdge(const string& from, const string& to) const {
+    const uint32_t a = IndexOf(from);
+    const uint32_t b = IndexOf(to);
+    return a == kInvalidNode || b == kInvalidNode ? kInvalidEdge : FindEdge(a, b);
+}
+
+void CompactGraph::SetEdgeWeight(uint32_t edge, float weight) {
+    if (edge >= numEdges_ || !(weight >= 0)) {
+        throw invalid_argument("invalid edge weight");
+    }
+    std::lock_guard<std::mutex> lock(edgeMutex_);
+    editable();
+    weights_[edge] = weight;
+    if (!closed_[edge]) {
+        changed(edge, lengths_[edge], weight);
+    }
+}
+
+void CompactGraph::SetEdgeEnabled(uint32_t edge, bool enabled) {
+    if (edge >= numEdges_) {
+        throw invalid_argument("invalid edge");
+    }
+    std::lock_guard<std::mutex> lock(edgeMutex_);
+    editable();
+    if (closed_[edge] != !enabled) {
+        closed_[edge] = !enabled;
+        changed(edge, lengths_[edge], enabled ? weights_[edge] : std::numeric_limits<float>::infinity());
+    }
+}
+
+bool CompactGraph::SetEdgeWeight(const string& from, const string& to, float weight) {
+    const uint32_t edge = FindEdge(from, to);
+    if (edge == kInvalidEdge) {
+        return false;
+    }
+    SetEdgeWeight(edge, weight);
+    return true;
+}
+
+bool CompactGraph::SetEdgeEnabled(const string& from, const string& to, bool enabled) {
+    const uint32_t edge = FindEdge(from, to);
+    if (edge == kInvalidEdge) {
+        return false;
+    }
+    SetEdgeEnabled(edge, enabled);
+    return true;
+}
+
+void CompactGraph::editable() {
+    if (!weights_.empty() || numEdges_ == 0) {
+        return;
+    }
+    weights_.assign(lengths_, lengths_ + numEdges_);
+    closed_.assign(numEdges_, 0);
+    if (lengths_ != ownedLengths_.data()) {
+        // mapped lengths are read only
+        ownedLengths_ = weights_;
+        lengths_ = ownedLengths_.data();
+    }
+}
+
+void CompactGraph::changed(uint32_t edge, float previous, float cost) {
+    if (cost == previous) {
+        return;
+    }
+    ownedLengths_[edge] = cost;
+    changes_.push_back({edge, cost < previous});
+    const uint64_t version = changes_.size();
+    if (cost < previous) {
+        lastDecrease_ = version;
+    }
+    version_ = version;
+    SetContractionHierarchy(nullptr);
+}
+
+vector<EdgeChange> CompactGraph::ChangesSince(uint64_t version) const {
+    std::lock_guard<std::mutex> lock(edgeMutex_);
+    if (version >= changes_.size()) {
+        return vector<EdgeChange>();
+    }
+    return vector<EdgeChange>(changes_.begin() + version, changes_.end());
+}
+
+uint32_t CompactGraphBuilder::AddNode(const string& name, const Point3& position) {
+    const uint32_t node = NumNodes();
+    if (!index_.insert({name, node}).second) {
+        // attempting to add duplicate Node
+        throw invalid_argument(name);
+    }
+    names_.push_back(name);
+    positions_.push_back(position[0]);
+    positions_.push_back(position[1]);
+    positions_.push_back(position[2]);
+    return node;
+}
+
+void CompactGraphBuilder::AddEdge(uint32_t from, uint32_t to) {
+    edges_.emplace_back(from, to);
+}
+
+bool CompactGraphBuilder::AddEdge(const string& from, const string& to) {
+    uint32_t a = IndexOf(from);
+    uint32_t b = IndexOf(to);
+    if (a == CompactGraph::kInvalidNode || b == CompactGraph::kInvalidNode) {
+        return false;
+    }
+    AddEdge(a, b);
+    return true;
+}
+
+uint32_t CompactGraphBuilder::IndexOf(const string& name) const {
+    auto result = index_.find(name);
+    return result == index_.end() ? CompactGraph::kInvalidNode : result->second;
+}
+
+CompactGraph* CompactGraphBuilder::Build() {
+    std::sort(edges_.begin(), edges_.end());
+    edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+
+    const uint32_t n = NumNodes();
+    vector<uint32_t> offsets(n + 1, 0);
+    vector<uint32_t> targets;
+    targets.reserve(edges_.size());
+    for (const auto& edge : edges_) {
+        offsets[edge.first + 1]++;
+        targets.push_back(edge.second);
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    CompactGraph* graph = new CompactGraph(std::move(names_), std::move(positions_),
+                                           std::move(offsets), std::move(targets));
+    names_.clear();
+    positions_.clear();
+    edges_.clear();
+    index_.clear();
+    return graph;
+}
+
+}
@@ -0,0 +1,141 @@
+#include "impl/graph_components.h"
+
+#include <algorithm>
+#include <numeric>
+
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const uint32_t kInvalid = CompactGraph::kInvalidNode;
+
+}
+
+UnionFind::UnionFind(uint32_t count) : parent_(count), size_(count, 1) {
+    std::iota(parent_.begin(), parent_.end(), 0);
+}
+
+uint32_t UnionFind::Find(uint32_t id) {
+    while (parent_[id] != id) {
+        parent_[id] = parent_[parent_[id]];
+        id = parent_[id];
+    }
+    return id;
+}
+
+bool UnionFind::Union(uint32_t a, uint32_t b) {
+    a = Find(a);
+    b = Find(b);
+    if (a == b) {
+        return false;
+    }
+    if (size_[a] < size_[b]) {
+        std::swap(a, b);
+    }
+    parent_[b] = a;
+    size_[a] += size_[b];
+    return true;
+}
+
+GraphComponents::GraphComponents(const vector<uint32_t>& ids) : labels_(ids.size()) {
+    vector<uint32_t> label(ids.size(), kInvalid);
+    for (size_t node = 0; node < ids.size(); node++) {
+        uint32_t& component = label[ids[node]];
+        if (component == kInvalid) {
+            component = static_cast<uint32_t>(sizes_.size());
+            sizes_.push_back(0);
+        }
+        labels_[node] = component;
+        sizes_[component]++;
+    }
+}
+
+GraphComponents GraphComponents::Connected(const CompactGraph& graph) {
+    const uint32_t n = graph.NumNodes();
+    UnionFind sets(n);
+    for (uint32_t node = 0; node < n; node++) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            sets.Union(node, graph.EdgeTarget(e));
+        }
+    }
+    vector<uint32_t> roots(n);
+    for (uint32_t node = 0; node < n; node++) {
+        roots[node] = sets.Find(node);
+    }
+    return GraphComponents(roots);
+}
+
+GraphComponents GraphComponents::StronglyConnected(const CompactGraph& graph) {
+    const uint32_t n = graph.NumNodes();
+    vector<uint32_t> index(n, kInvalid);
+    vector<uint32_t> low(n);
+    vector<uint32_t> component(n, kInvalid);
+    vector<uint32_t> stack;
+    // explicit call stack of (node, next edge to look at)
+    vector<std::pair<uint32_t, uint32_t> > frames;
+    uint32_t counter = 0;
+    uint32_t components = 0;
+
+    for (uint32_t start = 0; start < n; start++) {
+        if (index[start] != kInvalid) {
+            continue;
+        }
+        index[start] = low[start] = counter++;
+        stack.push_back(start);
+        frames.emplace_back(start, graph.EdgeBegin(start));
+        while (!frames.empty()) {
+            const uint32_t node = frames.back().first;
+            uint32_t& edge = frames.back().second;
+            if (edge < graph.EdgeEnd(node)) {
+                const uint32_t next = graph.EdgeTarget(edge++);
+                if (index[next] == kInvalid) {
+                    index[next] = low[next] = counter++;
+                    stack.push_back(next);
+                    frames.emplace_back(next, graph.EdgeBegin(next));
+                } else if (component[next] == kInvalid) {
+                    // still on the stack
+                    low[node] = std::min(low[node], index[next]);
+                }
+                continue;
+            }
+
+            frames.pop_back();
+            if (!frames.empty()) {
+                const uint32_t parent = frames.back().first;
+                low[parent] = std::min(low[parent], low[node]);
+            }
+            if (low[node] == index[node]) {
+                uint32_t member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    component[member] = components;
+                } while (member != node);
+                components++;
+            }
+        }
+    }
+    return GraphComponents(component);
+}
+
+uint32_t GraphComponents::Largest() const {
+    uint32_t largest = kInvalid;
+    for (uint32_t c = 0; c < Count(); c++) {
+        if (largest == kInvalid || sizes_[c] > sizes_[largest]) {
+            largest = c;
+        }
+    }
+    return largest;
+}
+
+vector<char> GraphComponents::Mask(uint32_t component) const {
+    vector<char> mask(labels_.size());
+    for (size_t node = 0; node < labels_.size(); node++) {
+        mask[node] = labels_[node] == component;
+    }
+    return mask;
+}
+
+}
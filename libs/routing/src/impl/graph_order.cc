@@ -0,0 +1,131 @@
+#include "impl/graph_order.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const uint32_t kGridSize = 1 << 16;
+
+// Distance of (x, y) along the Hilbert curve through a kGridSize square.
+uint64_t hilbertIndex(uint32_t x, uint32_t y) {
+    uint64_t d = 0;
+    for (uint32_t s = kGridSize / 2; s > 0; s /= 2) {
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        d += uint64_t(s) * s * ((3 * rx) ^ ry);
+        // rotate the quadrant so the curve stays continuous
+        if (ry == 0) {
+            if (rx == 1) {
+                x = kGridSize - 1 - x;
+                y = kGridSize - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+uint32_t gridCell(float value, float min, float max) {
+    if (!(max > min)) {
+        return 0;
+    }
+    const double cell = (double(value) - min) / (double(max) - min) * (kGridSize - 1);
+    return static_cast<uint32_t>(std::min<double>(std::max(cell, 0.0), kGridSize - 1));
+}
+
+}
+
+vector<uint32_t> GraphOrder::Compute(const CompactGraph& graph, NodeOrder order) {
+    switch (order) {
+        case NodeOrder::kHilbert:
+            return Hilbert(graph);
+        case NodeOrder::kBreadthFirst:
+            return BreadthFirst(graph);
+        default:
+            vector<uint32_t> identity(graph.NumNodes());
+            std::iota(identity.begin(), identity.end(), 0);
+            return identity;
+    }
+}
+
+vector<uint32_t> GraphOrder::Hilbert(const CompactGraph& graph) {
+    const uint32_t n = graph.NumNodes();
+    const BoundingBox bounds = graph.GetBoundingBox();
+    vector<std::pair<uint64_t, uint32_t> > keys(n);
+    for (uint32_t node = 0; node < n; node++) {
+        const float* p = graph.Position(node);
+        keys[node] = {hilbertIndex(gridCell(p[0], bounds.min[0], bounds.max[0]),
+                                   gridCell(p[2], bounds.min[2], bounds.max[2])), node};
+    }
+    // ties keep the old order
+    std::sort(keys.begin(), keys.end());
+
+    vector<uint32_t> order(n);
+    for (uint32_t i = 0; i < n; i++) {
+        order[i] = keys[i].second;
+    }
+    return order;
+}
+
+vector<uint32_t> GraphOrder::BreadthFirst(const CompactGraph& graph) {
+    const uint32_t n = graph.NumNodes();
+    vector<uint32_t> degree(n);
+    for (uint32_t node = 0; node < n; node++) {
+        degree[node] = graph.Degree(node) + graph.ReverseEdgeEnd(node) - graph.ReverseEdgeBegin(node);
+    }
+    auto byDegree = [&degree](uint32_t a, uint32_t b) {
+        return degree[a] != degree[b] ? degree[a] < degree[b] : a < b;
+    };
+    vector<uint32_t> starts(n);
+    std::iota(starts.begin(), starts.end(), 0);
+    std::sort(starts.begin(), starts.end(), byDegree);
+
+    // order doubles as the queue
+    vector<uint32_t> order;
+    order.reserve(n);
+    vector<char> visited(n, 0);
+    vector<uint32_t> neighbors;
+    for (uint32_t start : starts) {
+        if (visited[start]) {
+            continue;
+        }
+        visited[start] = 1;
+        order.push_back(start);
+        for (size_t head = order.size() - 1; head < order.size(); head++) {
+            const uint32_t node = order[head];
+            neighbors.clear();
+            for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+                neighbors.push_back(graph.EdgeTarget(e));
+            }
+            for (uint32_t r = graph.ReverseEdgeBegin(node); r < graph.ReverseEdgeEnd(node); r++) {
+                neighbors.push_back(graph.ReverseEdgeSource(r));
+            }
+            std::sort(neighbors.begin(), neighbors.end(), byDegree);
+            for (uint32_t next : neighbors) {
+                if (!visited[next]) {
+                    visited[next] = 1;
+                    order.push_back(next);
+                }
+            }
+        }
+    }
+    return order;
+}
+
+double GraphOrder::MeanEdgeSpan(const CompactGraph& graph) {
+    double total = 0;
+    for (uint32_t node = 0; node < graph.NumNodes(); node++) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            total += std::abs(static_cast<double>(node) - graph.EdgeTarget(e));
+        }
+    }
+    return graph.NumEdges() == 0 ? 0 : total / graph.NumEdges();
+}
+
+}
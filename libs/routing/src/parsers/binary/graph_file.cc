@@ -0,0 +1,154 @@
+#include "parsers/binary/graph_file.h"
+#include "util/mapped_file.h"
+
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+namespace routing {
+
+const char* const GraphFile::kExtension = ".rgraph";
+
+namespace {
+
+uint64_t aligned(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+void writeSection(std::ofstream& file, uint64_t offset, const void* data, uint64_t size) {
+    static const char zeros[8] = {0};
+    file.write(zeros, offset - static_cast<uint64_t>(file.tellp()));
+    file.write(static_cast<const char*>(data), size);
+}
+
+}
+
+void GraphFile::Write(const CompactGraph& graph, const string& filename) {
+    const CompactGraphArrays arrays = graph.Arrays();
+    const uint32_t n = arrays.numNodes;
+
+    // the euclidean lengths rather than the current costs: the format has
+    // no room for closed edges, and a mapped graph starts out without
+    // runtime changes like a renumbered one
+    vector<float> lengths(arrays.numEdges);
+    for (uint32_t node = 0; node < n; node++) {
+        const Point3 from = graph.PointAt(node);
+        for (uint32_t e = arrays.offsets[node]; e < arrays.offsets[node + 1]; e++) {
+            lengths[e] = from.distanceBetween(graph.PointAt(arrays.targets[e]));
+        }
+    }
+
+    vector<uint32_t> nameOffsets(n + 1, 0);
+    string names;
+    for (uint32_t node = 0; node < n; node++) {
+        names += graph.NameOf(node);
+        nameOffsets[node + 1] = static_cast<uint32_t>(names.size());
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kMagic;
+    header.version = kVersion;
+    header.numNodes = n;
+    header.numEdges = arrays.numEdges;
+    BoundingBox bounds = graph.GetBoundingBox();
+    for (int j = 0; j < 3 && n > 0; j++) {
+        header.boundsMin[j] = bounds.min[j];
+        header.boundsMax[j] = bounds.max[j];
+    }
+    header.namesSize = names.size();
+    header.positions = aligned(sizeof(Header));
+    header.offsets = aligned(header.positions + 3 * uint64_t(n) * sizeof(float));
+    header.targets = aligned(header.offsets + (uint64_t(n) + 1) * sizeof(uint32_t));
+    header.lengths = aligned(header.targets + uint64_t(arrays.numEdges) * sizeof(uint32_t));
+    header.nameOffsets = aligned(header.lengths + uint64_t(arrays.numEdges) * sizeof(float));
+    header.names = aligned(header.nameOffsets + (uint64_t(n) + 1) * sizeof(uint32_t));
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw runtime_error("cannot write graph file " + filename);
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeSection(file, header.positions, arrays.positions, 3 * uint64_t(n) * sizeof(float));
+    writeSection(file, header.offsets, arrays.offsets, (uint64_t(n) + 1) * sizeof(uint32_t));
+    writeSection(file, header.targets, arrays.targets, uint64_t(arrays.numEdges) * sizeof(uint32_t));
+    writeSection(file, header.lengths, lengths.data(), uint64_t(arrays.numEdges) * sizeof(float));
+    writeSection(file, header.nameOffsets, nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+    writeSection(file, header.names, names.data(), names.size());
+    if (!file) {
+        throw runtime_error("cannot write graph file " + filename);
+    }
+}
+
+CompactGraph* GraphFile::Map(const string& filename) {
+    std::shared_ptr<const MappedFile> mapping = std::make_shared<const MappedFile>(filename);
+    const char* data = mapping->Data();
+    const uint64_t size = mapping->Size();
+
+    Header header;
+    if (size < sizeof(header)) {
+        throw runtime_error("not a graph file: " + filename);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kMagic) {
+        throw runtime_error("not a graph file, or written on a machine with a different byte order: " + filename);
+    }
+    if (header.version != kVersion) {
+        throw runtime_error("unsupported graph file version " + std::to_string(header.version) + ": " + filename);
+    }
+
+    const uint64_t n = header.numNodes;
+    const uint64_t m = header.numEdges;
+    auto section = [&](uint64_t offset, uint64_t bytes) {
+        if (offset % 8 != 0 || offset > size || bytes > size - offset) {
+            throw runtime_error("truncated graph file: " + filename);
+        }
+        return data + offset;
+    };
+
+    CompactGraphArrays arrays;
+    arrays.numNodes = header.numNodes;
+    arrays.numEdges = header.numEdges;
+    arrays.positions = reinterpret_cast<const float*>(section(header.positions, 3 * n * sizeof(float)));
+    arrays.offsets = reinterpret_cast<const uint32_t*>(section(header.offsets, (n + 1) * sizeof(uint32_t)));
+    arrays.targets = reinterpret_cast<const uint32_t*>(section(header.targets, m * sizeof(uint32_t)));
+    arrays.lengths = reinterpret_cast<const float*>(section(header.lengths, m * sizeof(float)));
+    const uint32_t* nameOffsets =
+        reinterpret_cast<const uint32_t*>(section(header.nameOffsets, (n + 1) * sizeof(uint32_t)));
+    const char* names = section(header.names, header.namesSize);
+
+    // IGraphNode hands out names by reference, so they are the one part
+    // that has to be copied out of the mapping
+    vector<string> nodeNames;
+    nodeNames.reserve(n);
+    for (uint64_t node = 0; node < n; node++) {
+        if (nameOffsets[node] > nameOffsets[node + 1] || nameOffsets[node + 1] > header.namesSize) {
+            throw runtime_error("corrupt node names in graph file: " + filename);
+        }
+        nodeNames.emplace_back(names + nameOffsets[node], nameOffsets[node + 1] - nameOffsets[node]);
+    }
+
+    std::unique_ptr<CompactGraph> graph;
+    try {
+        graph.reset(new CompactGraph(std::move(nodeNames), arrays, mapping));
+    } catch (const std::invalid_argument& e) {
+        throw runtime_error("corrupt graph file " + filename + ": " + e.what());
+    }
+    // the graph recomputes its bounds from the positions, both come from
+    // the same min and max so they match exactly
+    const BoundingBox bounds = graph->GetBoundingBox();
+    for (int j = 0; j < 3 && n > 0; j++) {
+        if (header.boundsMin[j] != bounds.min[j] || header.boundsMax[j] != bounds.max[j]) {
+            throw runtime_error("corrupt graph file " + filename + ": bounds do not match the positions");
+        }
+    }
+    return graph.release();
+}
+
+}
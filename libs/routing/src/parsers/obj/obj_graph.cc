@@ -1,8 +1,87 @@
 #include "parsers/obj/obj_graph.h"
+#include "util/mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
 #include <fstream>
 
 namespace routing {
 
+namespace {
+
+const uint64_t kEmpty = UINT64_MAX;
+
+// Set of undirected edges packed as (smaller << 32) | larger, open
+// addressing in one array instead of a node per edge.
+class EdgeSet {
+public:
+    EdgeSet() : slots_(1024, kEmpty) {}
+
+    void Insert(uint32_t a, uint32_t b) {
+        const uint64_t key = a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        if (2 * (size_ + 1) > slots_.size()) {
+            grow();
+        }
+        if (place(slots_, key)) {
+            size_++;
+        }
+    }
+
+    const std::vector<uint64_t>& Slots() const { return slots_; }
+
+private:
+    static bool place(std::vector<uint64_t>& slots, uint64_t key) {
+        const size_t mask = slots.size() - 1;
+        // fibonacci hashing spreads the consecutive indices of a mesh
+        size_t slot = (key * 0x9E3779B97F4A7C15ull) >> 32 & mask;
+        while (slots[slot] != kEmpty) {
+            if (slots[slot] == key) {
+                return false;
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = key;
+        return true;
+    }
+
+    void grow() {
+        std::vector<uint64_t> slots(2 * slots_.size(), kEmpty);
+        for (uint64_t key : slots_) {
+            if (key != kEmpty) {
+                place(slots, key);
+            }
+        }
+        slots_.swap(slots);
+    }
+
+    std::vector<uint64_t> slots_;
+    size_t size_ = 0;
+};
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipBlanks(const char* p, const char* end) {
+    while (p < end && isBlank(*p)) {
+        p++;
+    }
+    return p;
+}
+
+// Parses the float at p, which may start with '+', and moves p past it.
+bool parseFloat(const char*& p, const char* end, float& value) {
+    p = skipBlanks(p, end);
+    if (p < end && *p == '+') {
+        p++;
+    }
+    std::from_chars_result result = std::from_chars(p, end, value);
+    p = result.ptr;
+    return result.ec == std::errc();
+}
+
+}
+
 ObjGraph::ObjGraph(const std::string& file) {
     std::ifstream objFile;
     objFile.open(file);
@@ -42,4 +121,90 @@ ObjGraph::ObjGraph(const std::string& file) {
     }
 }
 
+CompactGraph* ObjGraph::LoadCompactGraphFromFile(const std::string& file) {
+    MappedFile mapped(file);
+    const char* p = mapped.Data();
+    const char* const end = p + mapped.Size();
+
+    std::vector<float> positions;
+    EdgeSet edges;
+    std::vector<uint32_t> face;
+    while (p < end) {
+        p = skipBlanks(p, end);
+        const char* lineEnd = std::find(p, end, '\n');
+        if (lineEnd - p > 1 && p[0] == 'v' && isBlank(p[1])) {
+            p++;
+            float xyz[3] = {0, 0, 0};
+            for (int i = 0; i < 3 && parseFloat(p, lineEnd, xyz[i]); i++) {
+            }
+            positions.push_back(xyz[0]);
+            positions.push_back(xyz[2]);
+            positions.push_back(-xyz[1]);
+        } else if (lineEnd - p > 1 && p[0] == 'f' && isBlank(p[1])) {
+            // v, v/vt, v//vn or v/vt/vn, only v matters; negative indices
+            // count back from the last vertex
+            const int64_t numVertices = positions.size() / 3;
+            face.clear();
+            p++;
+            while ((p = skipBlanks(p, lineEnd)) < lineEnd) {
+                int64_t index = 0;
+                std::from_chars_result result = std::from_chars(p, lineEnd, index);
+                if (result.ec == std::errc()) {
+                    index = index < 0 ? numVertices + index : index - 1;
+                    if (index >= 0 && index < UINT32_MAX) {
+                        face.push_back(static_cast<uint32_t>(index));
+                    }
+                }
+                p = result.ptr;
+                while (p < lineEnd && !isBlank(*p)) {
+                    p++;
+                }
+            }
+            // the boundary of the polygon
+            for (size_t i = 0; face.size() > 1 && i < face.size(); i++) {
+                const uint32_t a = face[i];
+                const uint32_t b = face[(i + 1) % face.size()];
+                if (a != b) {
+                    edges.Insert(a, b);
+                }
+            }
+        }
+        p = lineEnd < end ? lineEnd + 1 : end;
+    }
+
+    // both directions of every edge between vertices that exist, faces may
+    // refer to vertices defined after them
+    const uint32_t n = static_cast<uint32_t>(positions.size() / 3);
+    std::vector<uint32_t> offsets(n + 1, 0);
+    for (uint64_t key : edges.Slots()) {
+        if (key != kEmpty && (key & UINT32_MAX) < n) {
+            offsets[(key >> 32) + 1]++;
+            offsets[(key & UINT32_MAX) + 1]++;
+        }
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        offsets[node + 1] += offsets[node];
+    }
+    std::vector<uint32_t> targets(offsets[n]);
+    std::vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for (uint64_t key : edges.Slots()) {
+        if (key != kEmpty && (key & UINT32_MAX) < n) {
+            const uint32_t a = static_cast<uint32_t>(key >> 32);
+            const uint32_t b = static_cast<uint32_t>(key & UINT32_MAX);
+            targets[next[a]++] = b;
+            targets[next[b]++] = a;
+        }
+    }
+    for (uint32_t node = 0; node < n; node++) {
+        std::sort(targets.begin() + offsets[node], targets.begin() + offsets[node + 1]);
+    }
+
+    std::vector<std::string> names;
+    names.reserve(n);
+    for (uint32_t node = 0; node < n; node++) {
+        names.push_back(std::to_string(node + 1));
+    }
+    return new CompactGraph(std::move(names), std::move(positions), std::move(offsets), std::move(targets));
+}
+
 }
@@ -41,12 +41,14 @@ void OSMGraph::AddNode(OSMNode* node) {
     }
     lookup_.insert({name, node});
     nodes_.push_back(node);
+    InvalidateCompactGraph();
 };
 
 void OSMGraph::AddEdge(const string name1, const string name2) {
     OSMNode* node1 = node_named(name1);
     OSMNode* node2 = node_named(name2);
     node1->AddNeighbour(node2);
+    InvalidateCompactGraph();
 };
 
 OSMNode* OSMGraph::node_named(const string name) const {
@@ -1,5 +1,5 @@
 #include "parsers/osm/osm_graph_factory.h"
-#include "parsers/osm/osm_parser.h"
+#include "parsers/osm/osm_stream_parser.h"
 
 #include <stdexcept>
 
@@ -10,7 +10,7 @@ IGraph* OSMGraphFactory::Create(const std::string& file) const {
 		return NULL;
 	}
 
-	return OsmParser::LoadGraphFromFile(file, false);
+	return OsmStreamParser::ParallelLoadCompactGraphFromFile(file);
 }
 
 }
\ No newline at end of file
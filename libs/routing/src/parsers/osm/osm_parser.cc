@@ -5,8 +5,8 @@
 #include <unordered_set>
 
 #include "parsers/osm/osm_parser.h"
+#include "impl/graph_components.h"
 #include "util/xml/pugixml.h"
-#include <limits.h>
 
 using std::logic_error;
 using std::invalid_argument;
@@ -16,149 +16,22 @@ using std::string;
 
 namespace routing {
 
-template <class T, class V>
-unordered_map<V, int>* count_value_occurrences(const unordered_map<T, V>* to_count) {
-    unordered_map<V, int>* result = new unordered_map<V, int>();
-
-    for (auto kv : *to_count) {
-        auto existing_info = result->find(kv.second);
-        if (existing_info == result->end()) {
-            result->insert({kv.second, 1});
-        } else {
-            existing_info->second += 1;
-        }
-    }
-
-    return result;
-};
-
-template <class T>
-T argmax(const unordered_map<T, int>* mapping) {
-    // this iterates through the list twice
-    // because T max_found; isn't always valid
-    // if T doesn't define a default constructor
-    int max = INT_MIN;
-
-    for (auto kv: *mapping) {
-        if(kv.second > max) {
-            max = kv.second;
-        }
-    }
-
-    for (auto kv: *mapping) {
-        if(kv.second == max) {
-            return kv.first;
-        }
-    }
-};
-
-template <class T, class V>
-unordered_map<T, bool>* where_equal(const unordered_map<T, int>* mapping, V equal_to){
-    unordered_map<T, bool>* result = new unordered_map<T, bool>();
-
-    for (auto kv: *mapping) {
-        result->insert({
-            kv.first,
-            kv.second == equal_to});
-    }
-
-    return result;
-}
-
-class GraphUtils {
-    public :  
-        static unordered_map<string, int>* ConnectedComponents(const IGraph* graph);
-        static OSMGraph* Filter(const IGraph* original, const unordered_map<string, bool>* filter);
-        static OSMGraph* FilterToLargestConnectedComponent(const IGraph* graph);
-    private:
-        static void dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index);
-};
-
-unordered_map<string, int>* GraphUtils::ConnectedComponents(const IGraph* graph) {
-    unordered_map<string, int>* visited = new unordered_map<string, int>();
-    int index = 0;
-
-    for (auto* node : graph->GetNodes()) {
-        if(visited->find(node->GetName()) == visited->end()) {
-            // we haven't seen this node before
-            GraphUtils::dfs_visit(node, visited, index);
-            index += 1;
-        }
-    }
-
-    return visited;
-}
-
-OSMGraph* GraphUtils::Filter(const IGraph* original, const unordered_map<string, bool>* filter) {
-    // NOTE: does not preserve the type of the graph that was input, always gives back an OSMGraph
-    OSMGraph* filtered_graph = new OSMGraph();
-
-    // copy over all of the nodes for which filter(node->GetName()) is true
-    for (auto kv : *filter) {
-        const bool include = kv.second;
-        if (include) {
-            const string name = kv.first;
-            const IGraphNode* existing_node = original->GetNode(name);
-            if(existing_node) {
-                vector<float> loc = existing_node->GetPosition();
-                filtered_graph->AddNode(
-                    new OSMNode(
-                        Point3(loc.at(0), loc.at(1), loc.at(2)),
-                        existing_node->GetName()));
-            } else {
-                throw logic_error(name);
-            }
-        }
-    }
-
-    for (IGraphNode* node : original->GetNodes()) {
-        auto from_filter = filter->find(node->GetName());
-        if (from_filter == filter->end()) {
-            throw invalid_argument(node->GetName());
-        } // implicit else
-        if (from_filter->second) {
-            // from node is in the filter            
-            for (IGraphNode* other : node->GetNeighbors()) {
-                auto to_filter = filter->find(other->GetName());
-                if (to_filter == filter->end()) {
-                    throw invalid_argument(node->GetName());
-                } // implicit else
-                if (to_filter->second) {
-                    // both nodes in the filter
-                    filtered_graph->AddEdge(node->GetName(), other->GetName());
-                }
-            }
-        }
+OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
+  CompactGraph* compact = LoadCompactGraphFromFile(filename, debug);
+  OSMGraph* graph = new OSMGraph();
+  for (uint32_t node = 0; node < compact->NumNodes(); node++) {
+    graph->AddNode(new OSMNode(compact->PointAt(node), compact->NameOf(node)));
+  }
+  for (uint32_t node = 0; node < compact->NumNodes(); node++) {
+    for (uint32_t e = compact->EdgeBegin(node); e < compact->EdgeEnd(node); e++) {
+      graph->AddEdge(compact->NameOf(node), compact->NameOf(compact->EdgeTarget(e)));
     }
-
-    return filtered_graph;
+  }
+  delete compact;
+  return graph;
 };
 
-OSMGraph* GraphUtils::FilterToLargestConnectedComponent(const IGraph* original) {
-    unordered_map<string, int>* cc_mapping = GraphUtils::ConnectedComponents(original);
-    unordered_map<int, int>* cc_sizes = count_value_occurrences(cc_mapping);
-    int largest_subgraph_idx = argmax(cc_sizes);
-    unordered_map<string, bool>* in_largest_cc = where_equal(cc_mapping, largest_subgraph_idx);
-    OSMGraph* result = GraphUtils::Filter(original, in_largest_cc);
-
-    delete cc_mapping;
-    delete cc_sizes;
-    delete in_largest_cc;
-    
-    return result;
-}
-
-void GraphUtils::dfs_visit(const IGraphNode* n, unordered_map<string, int>* record, int index) {
-    if (record->find(n->GetName()) == record->end()) {
-        record->insert({n->GetName(), index});
-
-        for (auto* neighbour : (n->GetNeighbors())) {
-            GraphUtils::dfs_visit(neighbour, record, index);
-        }
-    }
-}
-
-OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
+CompactGraph* OsmParser::LoadCompactGraphFromFile(string filename, bool debug) {
   pugi::xml_document doc;
   pugi::xml_parse_result result = doc.load_file(filename.c_str());
   // sanity check, make sure the document loaded, and print something (anything) from the document
@@ -167,12 +40,16 @@ OSMGraph* OsmParser::LoadGraphFromFile(string filename, bool debug) {
   #endif
 
   OSMGraph* geazy = read_nodes(&doc, debug);
-
   read_adjacencies_to(geazy, &doc, debug);
-  OSMGraph* connected = GraphUtils::FilterToLargestConnectedComponent(geazy);
+  CompactGraph* all = CompactGraph::FromGraph(*geazy);
   delete geazy;
+
+  // keep the largest connected component, by node index
+  GraphComponents components = GraphComponents::Connected(*all);
+  CompactGraph* connected = all->Subgraph(components.Mask(components.Largest()));
+  delete all;
   return connected;
-};
+}
 
 OSMGraph* OsmParser::without_lonely_nodes(OSMGraph* geazy) {
   // this literally creates a new graph that's a copy except for 
@@ -183,7 +60,7 @@ OSMGraph* OsmParser::without_lonely_nodes(OSMGraph* geazy) {
 
   for (IGraphNode* node : geazy->GetNodes()) {
     if(node->GetNeighbors().size() > 0) {
-      OSMNode* newNode = new OSMNode(node->GetPosition(), node->GetName());
+      OSMNode* newNode = new OSMNode(node->GetPoint(), node->GetName());
       newGraph->AddNode(newNode);
     }
   }
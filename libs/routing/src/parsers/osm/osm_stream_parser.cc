@@ -0,0 +1,605 @@
+#include "parsers/osm/osm_stream_parser.h"
+#include "parsers/osm/osm_parser.h"
+#include "impl/graph_components.h"
+#include "util/mapped_file.h"
+#include "util/thread_pool.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const size_t kChunkSize = 1 << 20;
+// smallest piece of a file that the parallel path tokenizes on its own
+const size_t kMinParallelChunk = 64 << 10;
+// separates the <nd> refs of a way where another element sits between them
+const int64_t kBreak = INT64_MIN;
+const uint32_t kInvalid = CompactGraph::kInvalidNode;
+
+bool isSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+bool equals(const char* text, size_t length, const char* literal) {
+    return length == std::strlen(literal) && std::memcmp(text, literal, length) == 0;
+}
+
+// Finds attribute name in the attribute text [begin, end) of a start tag.
+// The value is left unescaped, which is fine for ids, coordinates and keys.
+bool attribute(const char* begin, const char* end, const char* name,
+               const char*& value, size_t& length) {
+    const char* p = begin;
+    while (p < end) {
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        const char* key = p;
+        while (p < end && *p != '=' && !isSpace(*p)) {
+            p++;
+        }
+        const size_t keyLength = p - key;
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        if (p >= end || *p != '=') {
+            p++;
+            continue;
+        }
+        p++;
+        while (p < end && isSpace(*p)) {
+            p++;
+        }
+        if (p >= end || (*p != '"' && *p != '\'')) {
+            return false;
+        }
+        const char quote = *p++;
+        const char* start = p;
+        while (p < end && *p != quote) {
+            p++;
+        }
+        if (equals(key, keyLength, name)) {
+            value = start;
+            length = p - start;
+            return true;
+        }
+        p++;
+    }
+    return false;
+}
+
+// Values are always followed by their closing quote, which ends the number.
+bool attributeAsFloat(const char* begin, const char* end, const char* name, float& result) {
+    const char* value;
+    size_t length;
+    if (!attribute(begin, end, name, value, length) || length == 0) {
+        return false;
+    }
+    result = std::strtod(value, NULL);
+    return true;
+}
+
+bool attributeAsId(const char* begin, const char* end, const char* name, int64_t& result) {
+    const char* value;
+    size_t length;
+    if (!attribute(begin, end, name, value, length) || length == 0) {
+        return false;
+    }
+    result = std::strtoll(value, NULL, 10);
+    return true;
+}
+
+// One past the '>' that ends the markup starting at begin, or NULL if it
+// does not end before end.
+const char* markupEnd(const char* begin, const char* end) {
+    static const char* const kOpeners[] = {"<!--", "<![CDATA["};
+    static const char* const kClosers[] = {"-->", "]]>"};
+    for (int i = 0; i < 2; i++) {
+        const size_t openerLength = std::strlen(kOpeners[i]);
+        const size_t available = std::min(openerLength, static_cast<size_t>(end - begin));
+        if (std::memcmp(begin, kOpeners[i], available) == 0) {
+            if (available < openerLength) {
+                // cannot tell yet
+                return NULL;
+            }
+            const char* closer = kClosers[i];
+            const char* close = std::search(begin + openerLength, end, closer, closer + std::strlen(closer));
+            return close == end ? NULL : close + std::strlen(closer);
+        }
+    }
+
+    char quote = 0;
+    for (const char* p = begin + 1; p < end; p++) {
+        if (quote) {
+            quote = *p == quote ? 0 : quote;
+        } else if (*p == '"' || *p == '\'') {
+            quote = *p;
+        } else if (*p == '>') {
+            return p + 1;
+        }
+    }
+    return NULL;
+}
+
+// The first <node, <way or <relation tag at or after from. These never
+// sit inside a way, so the file can be split in front of them.
+const char* topLevelTag(const char* from, const char* end) {
+    static const char* const kNames[] = {"node", "way", "relation"};
+    for (const char* p = from; p < end; p++) {
+        p = static_cast<const char*>(std::memchr(p, '<', end - p));
+        if (!p) {
+            return end;
+        }
+        for (const char* name : kNames) {
+            const size_t length = std::strlen(name);
+            if (static_cast<size_t>(end - p) > length + 1 && std::memcmp(p + 1, name, length) == 0 &&
+                (isSpace(p[length + 1]) || p[length + 1] == '>' || p[length + 1] == '/')) {
+                return p;
+            }
+        }
+    }
+    return end;
+}
+
+}
+
+// Collects what the graph needs from one tag at a time. Ways keep their
+// <nd> refs until the closing tag, since their highway tag comes last.
+class OsmStreamParser::Reader {
+public:
+    explicit Reader(Extract& extract) : extract_(extract) {}
+
+    // Handles all complete markup in [begin, end) and returns where the
+    // first unfinished markup starts, or end.
+    const char* Scan(const char* begin, const char* end) {
+        while (true) {
+            const char* open = static_cast<const char*>(std::memchr(begin, '<', end - begin));
+            if (!open) {
+                return end;
+            }
+            const char* close = markupEnd(open, end);
+            if (!close) {
+                return open;
+            }
+            Markup(open, close);
+            begin = close;
+        }
+    }
+
+    // Handles the markup [begin, end), which starts with '<' and ends
+    // with '>'.
+    void Markup(const char* begin, const char* end) {
+        if (begin[1] == '?' || begin[1] == '!') {
+            return;
+        }
+        const bool closing = begin[1] == '/';
+        const char* name = begin + (closing ? 2 : 1);
+        const char* p = name;
+        while (p < end - 1 && !isSpace(*p) && *p != '/') {
+            p++;
+        }
+        const size_t nameLength = p - name;
+        if (closing) {
+            endTag(name, nameLength);
+            return;
+        }
+        const bool selfClosing = end - begin >= 2 && end[-2] == '/';
+        startTag(name, nameLength, p, end - (selfClosing ? 2 : 1));
+        if (selfClosing) {
+            endTag(name, nameLength);
+        }
+    }
+
+private:
+    void startTag(const char* name, size_t nameLength, const char* attributes, const char* end) {
+        if (inWay_) {
+            int64_t ref;
+            if (equals(name, nameLength, "nd") && attributeAsId(attributes, end, "ref", ref)) {
+                refs_.push_back(ref);
+                return;
+            }
+            const char* key;
+            size_t keyLength;
+            if (equals(name, nameLength, "tag") && attribute(attributes, end, "k", key, keyLength) &&
+                equals(key, keyLength, "highway")) {
+                highway_ = true;
+            }
+            // only directly consecutive <nd> elements form a segment
+            refs_.push_back(kBreak);
+        } else if (equals(name, nameLength, "node")) {
+            Extract::Node node;
+            if (!attributeAsId(attributes, end, "id", node.id)) {
+                std::cerr << "Improperly formed node missing id. Continuing." << std::endl;
+            } else if (!attributeAsFloat(attributes, end, "lat", node.lat)) {
+                std::cerr << "Improperly formed node missing lat. ID: " << node.id << ". Continuing" << std::endl;
+            } else if (!attributeAsFloat(attributes, end, "lon", node.lon)) {
+                std::cerr << "Improperly formed node missing lon. ID: " << node.id << ". Continuing" << std::endl;
+            } else {
+                extract_.nodes.push_back(node);
+            }
+        } else if (equals(name, nameLength, "way")) {
+            inWay_ = true;
+            highway_ = false;
+            refs_.clear();
+        } else if (equals(name, nameLength, "bounds")) {
+            extract_.hasBounds = attributeAsFloat(attributes, end, "minlat", extract_.minlat) &&
+                                 attributeAsFloat(attributes, end, "minlon", extract_.minlon) &&
+                                 attributeAsFloat(attributes, end, "maxlat", extract_.maxlat) &&
+                                 attributeAsFloat(attributes, end, "maxlon", extract_.maxlon);
+        }
+    }
+
+    void endTag(const char* name, size_t nameLength) {
+        if (!inWay_ || !equals(name, nameLength, "way")) {
+            return;
+        }
+        inWay_ = false;
+        if (highway_) {
+            for (size_t i = 1; i < refs_.size(); i++) {
+                if (refs_[i - 1] != kBreak && refs_[i] != kBreak) {
+                    extract_.segments.emplace_back(refs_[i - 1], refs_[i]);
+                }
+            }
+        }
+    }
+
+    Extract& extract_;
+    bool inWay_ = false;
+    bool highway_ = false;
+    vector<int64_t> refs_;
+};
+
+CompactGraph* OsmStreamParser::LoadCompactGraphFromFile(const string& filename, bool debug) {
+    std::unique_ptr<FILE, int (*)(FILE*)> file(std::fopen(filename.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("cannot open osm file " + filename);
+    }
+
+    Extract extract;
+    Reader reader(extract);
+    vector<char> buffer(kChunkSize);
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+    while (true) {
+        begin = reader.Scan(buffer.data() + begin, buffer.data() + end) - buffer.data();
+        if (eof) {
+            break;
+        }
+
+        // keep the unfinished markup and read the next chunk behind it
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+        if (end == buffer.size()) {
+            buffer.resize(2 * buffer.size());
+        }
+        const size_t read = std::fread(buffer.data() + end, 1, buffer.size() - end, file.get());
+        end += read;
+        eof = read == 0;
+    }
+    if (std::ferror(file.get())) {
+        throw std::runtime_error("cannot read osm file " + filename);
+    }
+
+    return BuildGraph(extract, debug);
+}
+
+CompactGraph* OsmStreamParser::BuildGraph(Extract& extract, bool debug) {
+    vector<Extract::Node>& nodes = extract.nodes;
+    std::stable_sort(nodes.begin(), nodes.end(),
+                     [](const Extract::Node& a, const Extract::Node& b) { return a.id < b.id; });
+    // the first of several nodes with the same id wins
+    size_t duplicates = nodes.size();
+    nodes.erase(std::unique(nodes.begin(), nodes.end(),
+                            [](const Extract::Node& a, const Extract::Node& b) { return a.id == b.id; }),
+                nodes.end());
+    duplicates -= nodes.size();
+    if (duplicates > 0) {
+        std::cerr << "Ignored " << duplicates << " duplicate nodes. Continuing." << std::endl;
+    }
+    const uint32_t n = static_cast<uint32_t>(nodes.size());
+
+    center(extract, NULL);
+
+    auto indexOf = [&](int64_t id) {
+        auto it = std::lower_bound(nodes.begin(), nodes.end(), id,
+                                   [](const Extract::Node& node, int64_t value) { return node.id < value; });
+        return it != nodes.end() && it->id == id ? static_cast<uint32_t>(it - nodes.begin()) : kInvalid;
+    };
+
+    // both directions of every segment, between indices into nodes
+    vector<pair<uint32_t, uint32_t> > edges;
+    edges.reserve(2 * extract.segments.size());
+    size_t missing = 0;
+    for (const auto& segment : extract.segments) {
+        const uint32_t a = indexOf(segment.first);
+        const uint32_t b = indexOf(segment.second);
+        if (a == kInvalid || b == kInvalid) {
+            missing++;
+            continue;
+        }
+        edges.emplace_back(a, b);
+        edges.emplace_back(b, a);
+    }
+    vector<pair<int64_t, int64_t> >().swap(extract.segments);
+    if (missing > 0) {
+        std::cerr << missing << " way segments reference unknown nodes. Continuing." << std::endl;
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    // largest connected component, ties go to the one with the lowest id
+    UnionFind sets(n);
+    for (const auto& edge : edges) {
+        sets.Union(edge.first, edge.second);
+    }
+    uint32_t largest = kInvalid;
+    for (uint32_t node = 0; node < n; node++) {
+        if (largest == kInvalid || sets.SetSize(node) > sets.SetSize(largest)) {
+            largest = sets.Find(node);
+        }
+    }
+
+    vector<uint32_t> index(n, kInvalid);
+    vector<string> names;
+    vector<float> positions;
+    for (uint32_t node = 0; node < n; node++) {
+        if (sets.Find(node) != largest) {
+            continue;
+        }
+        index[node] = static_cast<uint32_t>(names.size());
+        names.push_back(std::to_string(nodes[node].id));
+        positions.resize(positions.size() + 3);
+        project(extract, nodes[node], &positions[positions.size() - 3]);
+    }
+
+    // edges are sorted by source, and renumbering keeps the node order
+    vector<uint32_t> offsets(names.size() + 1, 0);
+    vector<uint32_t> targets;
+    for (const auto& edge : edges) {
+        if (index[edge.first] != kInvalid) {
+            offsets[index[edge.first] + 1]++;
+            targets.push_back(index[edge.second]);
+        }
+    }
+    for (size_t i = 0; i + 1 < offsets.size(); i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    if (debug) {
+        std::cerr << "Read " << n << " nodes and " << edges.size() / 2 << " highway segments, kept "
+                  << names.size() << " nodes and " << targets.size() << " edges" << std::endl;
+    }
+    return new CompactGraph(std::move(names), std::move(positions), std::move(offsets), std::move(targets));
+}
+
+CompactGraph* OsmStreamParser::ParallelLoadCompactGraphFromFile(const string& filename, unsigned threads,
+                                                                bool debug) {
+    ThreadPool pool(threads);
+    if (pool.Size() == 1) {
+        return LoadCompactGraphFromFile(filename, debug);
+    }
+    const MappedFile file(filename);
+    const char* data = file.Data();
+    const char* fileEnd = data + file.Size();
+
+    // a few chunks per thread evens out dense and sparse parts of the file
+    const size_t chunks = std::max<size_t>(1, std::min<size_t>(4 * pool.Size(), file.Size() / kMinParallelChunk));
+    vector<const char*> bounds(chunks + 1, fileEnd);
+    bounds[0] = data;
+    for (size_t c = 1; c < chunks; c++) {
+        bounds[c] = std::max(bounds[c - 1], topLevelTag(data + file.Size() * c / chunks, fileEnd));
+    }
+    vector<Extract> extracts(chunks);
+    pool.Run(chunks, [&](size_t c) {
+        Reader reader(extracts[c]);
+        reader.Scan(bounds[c], bounds[c + 1]);
+    });
+
+    // all nodes in file order, as the serial reader sees them
+    Extract extract;
+    vector<size_t> first(chunks + 1, 0);
+    for (size_t c = 0; c < chunks; c++) {
+        first[c + 1] = first[c] + extracts[c].nodes.size();
+        if (extracts[c].hasBounds && !extract.hasBounds) {
+            extract.hasBounds = true;
+            extract.minlat = extracts[c].minlat;
+            extract.minlon = extracts[c].minlon;
+            extract.maxlat = extracts[c].maxlat;
+            extract.maxlon = extracts[c].maxlon;
+        }
+    }
+    vector<Extract::Node>& nodes = extract.nodes;
+    nodes.resize(first[chunks]);
+    pool.Run(chunks, [&](size_t c) {
+        std::copy(extracts[c].nodes.begin(), extracts[c].nodes.end(), nodes.begin() + first[c]);
+        vector<Extract::Node>().swap(extracts[c].nodes);
+    });
+    const uint32_t n = static_cast<uint32_t>(nodes.size());
+
+    // id -> first node with that id, one shard per thread so that every
+    // shard is filled by a single thread in file order
+    const size_t shards = pool.Size();
+    auto shardOf = [shards](int64_t id) {
+        return static_cast<size_t>((static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> 32) % shards;
+    };
+    vector<vector<vector<uint32_t> > > buckets(chunks, vector<vector<uint32_t> >(shards));
+    pool.Run(chunks, [&](size_t c) {
+        for (size_t i = first[c]; i < first[c + 1]; i++) {
+            buckets[c][shardOf(nodes[i].id)].push_back(static_cast<uint32_t>(i));
+        }
+    });
+    vector<std::unordered_map<int64_t, uint32_t> > table(shards);
+    vector<char> canonical(n, 0);
+    vector<size_t> duplicates(shards, 0);
+    pool.Run(shards, [&](size_t s) {
+        table[s].reserve(n / shards + 1);
+        for (size_t c = 0; c < chunks; c++) {
+            for (uint32_t i : buckets[c][s]) {
+                if (table[s].emplace(nodes[i].id, i).second) {
+                    canonical[i] = 1;
+                } else {
+                    duplicates[s]++;
+                }
+            }
+            vector<uint32_t>().swap(buckets[c][s]);
+        }
+    });
+    const size_t duplicateCount = std::accumulate(duplicates.begin(), duplicates.end(), size_t(0));
+    if (duplicateCount > 0) {
+        std::cerr << "Ignored " << duplicateCount << " duplicate nodes. Continuing." << std::endl;
+    }
+    center(extract, &canonical);
+
+    // segments as pairs of node indices
+    vector<vector<pair<uint32_t, uint32_t> > > segments(chunks);
+    vector<size_t> missing(chunks, 0);
+    pool.Run(chunks, [&](size_t c) {
+        auto indexOf = [&](int64_t id) {
+            const std::unordered_map<int64_t, uint32_t>& shard = table[shardOf(id)];
+            auto it = shard.find(id);
+            return it == shard.end() ? kInvalid : it->second;
+        };
+        segments[c].reserve(extracts[c].segments.size());
+        for (const auto& segment : extracts[c].segments) {
+            const uint32_t a = indexOf(segment.first);
+            const uint32_t b = indexOf(segment.second);
+            if (a == kInvalid || b == kInvalid) {
+                missing[c]++;
+            } else {
+                segments[c].emplace_back(a, b);
+            }
+        }
+        vector<pair<int64_t, int64_t> >().swap(extracts[c].segments);
+    });
+    vector<std::unordered_map<int64_t, uint32_t> >().swap(table);
+    const size_t missingCount = std::accumulate(missing.begin(), missing.end(), size_t(0));
+    if (missingCount > 0) {
+        std::cerr << missingCount << " way segments reference unknown nodes. Continuing." << std::endl;
+    }
+
+    // largest connected component, ties go to the one with the lowest id
+    // like in BuildGraph
+    UnionFind sets(n);
+    for (const auto& chunk : segments) {
+        for (const auto& segment : chunk) {
+            sets.Union(segment.first, segment.second);
+        }
+    }
+    uint32_t largest = kInvalid;
+    uint32_t lowest = kInvalid;
+    for (uint32_t node = 0; node < n; node++) {
+        if (!canonical[node]) {
+            continue;
+        }
+        const uint32_t root = sets.Find(node);
+        if (largest == kInvalid || sets.SetSize(root) > sets.SetSize(largest) ||
+            (sets.SetSize(root) == sets.SetSize(largest) && nodes[node].id < nodes[lowest].id)) {
+            largest = root;
+            lowest = node;
+        }
+    }
+
+    // number the kept nodes in id order
+    vector<uint32_t> kept;
+    for (uint32_t node = 0; node < n; node++) {
+        if (canonical[node] && sets.Find(node) == largest) {
+            kept.push_back(node);
+        }
+    }
+    ParallelStableSort(pool, kept, [&](uint32_t a, uint32_t b) { return nodes[a].id < nodes[b].id; });
+    const size_t m = kept.size();
+    vector<uint32_t> index(n, kInvalid);
+    vector<string> names(m);
+    vector<float> positions(3 * m);
+    pool.Run(pool.Size(), [&](size_t slice) {
+        for (size_t k = m * slice / pool.Size(); k < m * (slice + 1) / pool.Size(); k++) {
+            index[kept[k]] = static_cast<uint32_t>(k);
+            names[k] = std::to_string(nodes[kept[k]].id);
+            project(extract, nodes[kept[k]], &positions[3 * k]);
+        }
+    });
+
+    // both directions of every segment, sorted and deduplicated
+    vector<size_t> firstEdge(chunks + 1, 0);
+    pool.Run(chunks, [&](size_t c) {
+        size_t count = 0;
+        for (const auto& segment : segments[c]) {
+            count += index[segment.first] != kInvalid ? 2 : 0;
+        }
+        firstEdge[c + 1] = count;
+    });
+    std::partial_sum(firstEdge.begin(), firstEdge.end(), firstEdge.begin());
+    vector<pair<uint32_t, uint32_t> > edges(firstEdge[chunks]);
+    pool.Run(chunks, [&](size_t c) {
+        size_t e = firstEdge[c];
+        for (const auto& segment : segments[c]) {
+            const uint32_t a = index[segment.first];
+            const uint32_t b = index[segment.second];
+            if (a != kInvalid) {
+                edges[e++] = {a, b};
+                edges[e++] = {b, a};
+            }
+        }
+        vector<pair<uint32_t, uint32_t> >().swap(segments[c]);
+    });
+    ParallelStableSort(pool, edges, std::less<pair<uint32_t, uint32_t> >());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    vector<uint32_t> offsets(m + 1, 0);
+    vector<uint32_t> targets(edges.size());
+    for (size_t e = 0; e < edges.size(); e++) {
+        offsets[edges[e].first + 1]++;
+        targets[e] = edges[e].second;
+    }
+    for (size_t i = 0; i < m; i++) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    if (debug) {
+        std::cerr << "Read " << n << " nodes in " << chunks << " chunks on " << pool.Size()
+                  << " threads, kept " << m << " nodes and " << targets.size() << " edges" << std::endl;
+    }
+    return new CompactGraph(std::move(names), std::move(positions), std::move(offsets), std::move(targets));
+}
+
+void OsmStreamParser::center(Extract& extract, const vector<char>* include) {
+    if (!extract.hasBounds) {
+        bool first = true;
+        for (size_t i = 0; i < extract.nodes.size(); i++) {
+            if (include && !(*include)[i]) {
+                continue;
+            }
+            const Extract::Node& node = extract.nodes[i];
+            extract.minlat = first ? node.lat : std::min(extract.minlat, node.lat);
+            extract.maxlat = first ? node.lat : std::max(extract.maxlat, node.lat);
+            extract.minlon = first ? node.lon : std::min(extract.minlon, node.lon);
+            extract.maxlon = first ? node.lon : std::max(extract.maxlon, node.lon);
+            first = false;
+        }
+    }
+    extract.centerLat = extract.minlat + (extract.maxlat - extract.minlat) / 2.0;
+    extract.centerLon = extract.minlon + (extract.maxlon - extract.minlon) / 2.0;
+}
+
+void OsmStreamParser::project(const Extract& extract, const Extract::Node& node, float* position) {
+    position[0] = OsmParser::getLon(node.lat, node.lon, extract.centerLat, extract.centerLon);
+    position[1] = 264.0f;
+    position[2] = -(node.lat - extract.centerLat) * 40008000.0 / 360.0;
+}
+
+}
@@ -0,0 +1,128 @@
+#include "route_cache.h"
+#include "impl/compact_graph.h"
+
+#include <algorithm>
+#include <functional>
+
+namespace routing {
+
+size_t RouteCache::KeyHash::operator()(const Key& key) const {
+    std::hash<const void*> hash;
+    size_t seed = hash(key.start);
+    seed ^= hash(key.end) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    seed ^= hash(key.strategy) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    return seed;
+}
+
+void RouteCache::Synchronize(const CompactGraph& graph) {
+    const uint64_t version = graph.Version();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (graph_ == &graph && version_ == version) {
+        return;
+    }
+    if (graph_ != &graph) {
+        invalidations_ += entries_.size();
+        clear();
+        graph_ = &graph;
+        version_ = version;
+        return;
+    }
+
+    const std::vector<EdgeChange> changes = graph.ChangesSince(version_);
+    version_ += changes.size();
+    for (const EdgeChange& change : changes) {
+        if (change.decreased) {
+            invalidations_ += entries_.size();
+            clear();
+            return;
+        }
+        auto found = byEdge_.find(change.edge);
+        if (found != byEdge_.end()) {
+            // erase() edits the list while it runs
+            const std::vector<Entries::iterator> users = found->second;
+            for (Entries::iterator entry : users) {
+                erase(entry);
+            }
+            invalidations_ += users.size();
+        }
+    }
+}
+
+SharedPath RouteCache::Find(const IGraphNode* start, const IGraphNode* end,
+                            const RoutingStrategy* strategy) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(Key{start, end, strategy});
+    if (found == index_.end()) {
+        misses_++;
+        return nullptr;
+    }
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->path;
+}
+
+void RouteCache::Insert(const IGraphNode* start, const IGraphNode* end,
+                        const RoutingStrategy* strategy, SharedPath path,
+                        std::vector<uint32_t> edges, uint64_t version) {
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (capacity_ == 0 || version < version_) {
+        return;
+    }
+    const Key key{start, end, strategy};
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+        erase(found->second);
+    } else if (entries_.size() >= capacity_) {
+        erase(std::prev(entries_.end()));
+        evictions_++;
+    }
+    entries_.push_front(Entry{key, std::move(path), std::move(edges)});
+    index_.insert({key, entries_.begin()});
+    for (uint32_t edge : entries_.front().edges) {
+        byEdge_[edge].push_back(entries_.begin());
+    }
+}
+
+void RouteCache::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    clear();
+    graph_ = nullptr;
+    version_ = 0;
+}
+
+RouteCacheStats RouteCache::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    RouteCacheStats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.invalidations = invalidations_;
+    stats.size = entries_.size();
+    stats.capacity = capacity_;
+    return stats;
+}
+
+void RouteCache::erase(Entries::iterator entry) {
+    for (uint32_t edge : entry->edges) {
+        auto found = byEdge_.find(edge);
+        std::vector<Entries::iterator>& users = found->second;
+        *std::find(users.begin(), users.end(), entry) = users.back();
+        users.pop_back();
+        if (users.empty()) {
+            byEdge_.erase(found);
+        }
+    }
+    index_.erase(entry->key);
+    entries_.erase(entry);
+}
+
+void RouteCache::clear() {
+    entries_.clear();
+    index_.clear();
+    byEdge_.clear();
+}
+
+}
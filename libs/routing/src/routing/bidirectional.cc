@@ -0,0 +1,112 @@
+#include "routing/bidirectional.h"
+#include "routing/search_engine.h"
+
+#include <limits>
+#include <typeinfo>
+#include <vector>
+
+using namespace std;
+
+namespace routing {
+
+BidirectionalSearch::~BidirectionalSearch() {
+    delete heuristic;
+}
+
+vector<string> BidirectionalSearch::GetPath(const IGraph* graph, const std::string& from, const std::string& to) const {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    const uint32_t source = SearchEngine::RequireNode(compact, from, "from");
+    const uint32_t target = SearchEngine::RequireNode(compact, to, "to");
+
+    SearchWorkspace& forward = SearchWorkspace::ForCurrentThread(0);
+    SearchWorkspace& backward = SearchWorkspace::ForCurrentThread(1);
+    forward.Reset(compact.NumNodes());
+    backward.Reset(compact.NumNodes());
+    IndexedHeap& forwardHeap = forward.Heap();
+    IndexedHeap& backwardHeap = backward.Heap();
+
+    // Forward keys are d(s, v) + p(v) and backward keys d(v, t) - p(v) with
+    // p(v) = (h(v, t) - h(v, s)) / 2. Both searches then run on the same
+    // reduced edge costs, so the usual stopping rule applies to the keys.
+    const bool zero = typeid(*heuristic) == typeid(ZeroDistance);
+    const bool euclidean = typeid(*heuristic) == typeid(EuclideanDistance);
+    const float* sourcePos = compact.Position(source);
+    const float* targetPos = compact.Position(target);
+    auto potential = [&](uint32_t node) -> float {
+        if (zero) {
+            return 0;
+        }
+        const float* p = compact.Position(node);
+        if (euclidean) {
+            return 0.5f * (EuclideanPolicy::Between(p, targetPos) - EuclideanPolicy::Between(p, sourcePos));
+        }
+        return 0.5f * (heuristic->Calculate(p, targetPos) - heuristic->Calculate(p, sourcePos));
+    };
+
+    forward.Reach(source, 0, CompactGraph::kInvalidNode);
+    forwardHeap.Push(source, potential(source));
+    backward.Reach(target, 0, CompactGraph::kInvalidNode);
+    backwardHeap.Push(target, -potential(target));
+
+    float best = source == target ? 0 : numeric_limits<float>::infinity();
+    uint32_t meeting = source == target ? source : CompactGraph::kInvalidNode;
+
+    while (!forwardHeap.Empty() && !backwardHeap.Empty()) {
+        if (forwardHeap.TopKey() + backwardHeap.TopKey() >= best) {
+            break;
+        }
+        // gives up with the best meeting point so far, if any
+        if (forward.Exhausted(backward.SettledCount())) {
+            break;
+        }
+
+        // expand the side with fewer queued nodes. Alternating by key grows
+        // both to the same radius, which on a bounded map wastes work on
+        // the side that starts in the middle of it.
+        if (forwardHeap.Size() <= backwardHeap.Size()) {
+            const uint32_t node = forwardHeap.Pop();
+            forward.Settle(node);
+            const float distance = forward.Distance(node);
+            for (uint32_t e = compact.EdgeBegin(node); e < compact.EdgeEnd(node); e++) {
+                const uint32_t next = compact.EdgeTarget(e);
+                const float candidate = distance + compact.EdgeLength(e);
+                if (!forward.Settled(next) && candidate < forward.Distance(next)) {
+                    forward.Reach(next, candidate, node);
+                    forwardHeap.Push(next, candidate + potential(next));
+                }
+                if (backward.Reached(next) && candidate + backward.Distance(next) < best) {
+                    best = candidate + backward.Distance(next);
+                    meeting = next;
+                }
+            }
+        } else {
+            const uint32_t node = backwardHeap.Pop();
+            backward.Settle(node);
+            const float distance = backward.Distance(node);
+            for (uint32_t r = compact.ReverseEdgeBegin(node); r < compact.ReverseEdgeEnd(node); r++) {
+                const uint32_t next = compact.ReverseEdgeSource(r);
+                const float candidate = distance + compact.EdgeLength(compact.ReverseEdgeForward(r));
+                if (!backward.Settled(next) && candidate < backward.Distance(next)) {
+                    backward.Reach(next, candidate, node);
+                    backwardHeap.Push(next, candidate - potential(next));
+                }
+                if (forward.Reached(next) && candidate + forward.Distance(next) < best) {
+                    best = candidate + forward.Distance(next);
+                    meeting = next;
+                }
+            }
+        }
+    }
+
+    vector<uint32_t> path;
+    if (meeting != CompactGraph::kInvalidNode) {
+        forward.PathTo(meeting, path);
+        // backward parents point towards the target
+        for (uint32_t at = backward.Parent(meeting); at != CompactGraph::kInvalidNode; at = backward.Parent(at)) {
+            path.push_back(at);
+        }
+    }
+    return SearchEngine::ToNames(compact, path);
+}
+
+}
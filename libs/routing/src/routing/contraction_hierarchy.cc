@@ -0,0 +1,538 @@
+#include "routing/contraction_hierarchy.h"
+#include "routing/search_engine.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+using std::string;
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const uint32_t kInvalid = CompactGraph::kInvalidNode;
+const float kInfinity = std::numeric_limits<float>::infinity();
+
+// Witness searches give up after this many settled nodes. Stopping early
+// only costs extra shortcuts, never correctness.
+const uint32_t kWitnessSettleLimit = 128;
+
+const uint32_t kFileMagic = 0x48434452; // "RDCH"
+const uint32_t kFileVersion = 1;
+
+struct WorkArc {
+    uint32_t node;
+    float weight;
+    uint32_t middle;
+};
+
+struct Shortcut {
+    uint32_t from;
+    uint32_t to;
+    float weight;
+    uint32_t middle;
+};
+
+typedef vector<vector<WorkArc> > WorkGraph;
+
+// Adds the arc, or lowers the weight of an existing arc to the same node.
+void improveArc(vector<WorkArc>& arcs, const WorkArc& arc) {
+    for (WorkArc& existing : arcs) {
+        if (existing.node == arc.node) {
+            if (arc.weight < existing.weight) {
+                existing = arc;
+            }
+            return;
+        }
+    }
+    arcs.push_back(arc);
+}
+
+void removeArc(vector<WorkArc>& arcs, uint32_t node) {
+    for (size_t i = 0; i < arcs.size(); i++) {
+        if (arcs[i].node == node) {
+            arcs[i] = arcs.back();
+            arcs.pop_back();
+            return;
+        }
+    }
+}
+
+// Dijkstra over the remaining graph that never passes through the node
+// being contracted.
+class WitnessSearch {
+    public:
+        void Run(const WorkGraph& out, uint32_t source, uint32_t avoid, float limit) {
+            workspace.Reset(static_cast<uint32_t>(out.size()));
+            IndexedHeap& heap = workspace.Heap();
+            workspace.Reach(source, 0, kInvalid);
+            heap.Push(source, 0);
+            while (!heap.Empty() && heap.TopKey() <= limit &&
+                   workspace.SettledCount() < kWitnessSettleLimit) {
+                const uint32_t node = heap.Pop();
+                workspace.Settle(node);
+                const float distance = workspace.Distance(node);
+                for (const WorkArc& arc : out[node]) {
+                    const float candidate = distance + arc.weight;
+                    if (arc.node != avoid && candidate < workspace.Distance(arc.node)) {
+                        workspace.Reach(arc.node, candidate, node);
+                        heap.Push(arc.node, candidate);
+                    }
+                }
+            }
+        }
+
+        float Distance(uint32_t node) const { return workspace.Distance(node); }
+
+    private:
+        SearchWorkspace workspace;
+};
+
+// Shortcuts needed to contract node: one for every in/out arc pair whose
+// path through node has no witness at most as short.
+void findShortcuts(const WorkGraph& out, const WorkGraph& in, uint32_t node,
+                   WitnessSearch& witness, vector<Shortcut>& shortcuts) {
+    shortcuts.clear();
+    for (const WorkArc& first : in[node]) {
+        float longest = -1;
+        for (const WorkArc& second : out[node]) {
+            if (second.node != first.node) {
+                longest = std::max(longest, second.weight);
+            }
+        }
+        if (longest < 0) {
+            continue;
+        }
+
+        witness.Run(out, first.node, node, first.weight + longest);
+        for (const WorkArc& second : out[node]) {
+            const float via = first.weight + second.weight;
+            if (second.node != first.node && witness.Distance(second.node) > via) {
+                shortcuts.push_back({first.node, second.node, via, node});
+            }
+        }
+    }
+}
+
+uint64_t fingerprint(const CompactGraph& graph) {
+    // FNV-1a over the topology and the node positions
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    const uint32_t n = graph.NumNodes();
+    mix(&n, sizeof(n));
+    for (uint32_t node = 0; node < n; node++) {
+        mix(graph.Position(node), 3 * sizeof(float));
+        const uint32_t degree = graph.Degree(node);
+        mix(&degree, sizeof(degree));
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t target = graph.EdgeTarget(e);
+            mix(&target, sizeof(target));
+        }
+    }
+    // the costs follow from the positions until an edge is changed
+    if (graph.Version() > 0) {
+        for (uint32_t e = 0; e < graph.NumEdges(); e++) {
+            const float length = graph.EdgeLength(e);
+            mix(&length, sizeof(length));
+        }
+    }
+    return hash;
+}
+
+template <class T>
+void writeValue(std::ofstream& file, const T& value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <class T>
+void writeVector(std::ofstream& file, const vector<T>& values) {
+    writeValue(file, static_cast<uint64_t>(values.size()));
+    file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <class T>
+bool readValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <class T>
+bool readVector(std::ifstream& file, vector<T>& values, uint64_t maxSize) {
+    uint64_t size;
+    if (!readValue(file, size) || size > maxSize) {
+        return false;
+    }
+    values.resize(size);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+}
+
+}
+
+ContractionHierarchy::ContractionHierarchy(const CompactGraph& graph) {
+    contract(graph);
+}
+
+void ContractionHierarchy::contract(const CompactGraph& graph) {
+    const uint32_t n = graph.NumNodes();
+    fingerprint_ = fingerprint(graph);
+
+    WorkGraph out(n), in(n);
+    for (uint32_t node = 0; node < n; node++) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t target = graph.EdgeTarget(e);
+            if (target != node && graph.EdgeOpen(e)) {
+                out[node].push_back({target, graph.EdgeLength(e), kInvalid});
+                in[target].push_back({node, graph.EdgeLength(e), kInvalid});
+            }
+        }
+    }
+
+    // Order by edge difference plus the number of contracted neighbors,
+    // which spreads the contraction evenly over the graph. Priorities are
+    // refreshed lazily when a node reaches the top of the queue.
+    WitnessSearch witness;
+    vector<Shortcut> shortcuts;
+    vector<uint32_t> contractedNeighbors(n, 0);
+    auto priority = [&](uint32_t node) {
+        findShortcuts(out, in, node, witness, shortcuts);
+        return float(shortcuts.size()) - float(out[node].size() + in[node].size()) +
+               float(contractedNeighbors[node]);
+    };
+
+    IndexedHeap queue;
+    queue.Resize(n);
+    for (uint32_t node = 0; node < n; node++) {
+        queue.Push(node, priority(node));
+    }
+
+    WorkGraph upArcs(n), downArcs(n);
+    rank_.assign(n, 0);
+    uint32_t nextRank = 0;
+    while (!queue.Empty()) {
+        const uint32_t node = queue.Pop();
+        const float current = priority(node);
+        if (!queue.Empty() && current > queue.TopKey()) {
+            queue.Push(node, current);
+            continue;
+        }
+
+        // every remaining neighbor is contracted later, so ranks higher
+        rank_[node] = nextRank++;
+        upArcs[node].swap(out[node]);
+        downArcs[node].swap(in[node]);
+        for (const WorkArc& arc : upArcs[node]) {
+            removeArc(in[arc.node], node);
+            contractedNeighbors[arc.node]++;
+        }
+        for (const WorkArc& arc : downArcs[node]) {
+            removeArc(out[arc.node], node);
+            contractedNeighbors[arc.node]++;
+        }
+        // shortcuts is still filled in by the priority() call above
+        for (const Shortcut& shortcut : shortcuts) {
+            improveArc(out[shortcut.from], {shortcut.to, shortcut.weight, shortcut.middle});
+            improveArc(in[shortcut.to], {shortcut.from, shortcut.weight, shortcut.middle});
+        }
+    }
+
+    numShortcuts_ = 0;
+    auto flatten = [this](WorkGraph& lists, ArcList& result) {
+        result.offsets.assign(1, 0);
+        for (vector<WorkArc>& arcs : lists) {
+            for (const WorkArc& arc : arcs) {
+                result.arcs.push_back({arc.node, arc.weight, arc.middle});
+                numShortcuts_ += arc.middle != kInvalid;
+            }
+            result.offsets.push_back(static_cast<uint32_t>(result.arcs.size()));
+            vector<WorkArc>().swap(arcs);
+        }
+    };
+    flatten(upArcs, up_);
+    flatten(downArcs, down_);
+}
+
+ContractionHierarchy* ContractionHierarchy::Load(const string& filename, const CompactGraph& graph) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("unable to open contraction hierarchy " + filename);
+    }
+
+    uint32_t magic = 0, version = 0;
+    ContractionHierarchy* hierarchy = new ContractionHierarchy();
+    bool valid = readValue(file, magic) && readValue(file, version) &&
+                 magic == kFileMagic && version == kFileVersion &&
+                 readValue(file, hierarchy->fingerprint_) &&
+                 readValue(file, hierarchy->numShortcuts_);
+    if (valid && hierarchy->fingerprint_ != fingerprint(graph)) {
+        delete hierarchy;
+        throw std::runtime_error("contraction hierarchy " + filename + " was built for a different graph");
+    }
+
+    const uint64_t n = graph.NumNodes();
+    // shortcuts are bounded by the number of node pairs
+    const uint64_t maxArcs = graph.NumEdges() + n * n;
+    valid = valid &&
+            readVector(file, hierarchy->rank_, n) && hierarchy->rank_.size() == n &&
+            readVector(file, hierarchy->up_.offsets, n + 1) &&
+            readVector(file, hierarchy->up_.arcs, maxArcs) &&
+            readVector(file, hierarchy->down_.offsets, n + 1) &&
+            readVector(file, hierarchy->down_.arcs, maxArcs);
+    for (const ArcList* list : {&hierarchy->up_, &hierarchy->down_}) {
+        valid = valid && list->offsets.size() == n + 1 && list->offsets.back() == list->arcs.size();
+    }
+    if (valid && !hierarchy->consistent()) {
+        valid = false;
+    }
+    if (!valid) {
+        delete hierarchy;
+        throw std::runtime_error("invalid contraction hierarchy " + filename);
+    }
+    return hierarchy;
+}
+
+bool ContractionHierarchy::consistent() const {
+    const uint32_t n = static_cast<uint32_t>(rank_.size());
+    vector<char> seen(n, 0);
+    for (uint32_t rank : rank_) {
+        if (rank >= n || seen[rank]) {
+            return false;
+        }
+        seen[rank] = 1;
+    }
+    for (const ArcList* list : {&up_, &down_}) {
+        if (list->offsets[0] != 0) {
+            return false;
+        }
+        for (uint32_t node = 0; node < n; node++) {
+            if (list->offsets[node] > list->offsets[node + 1]) {
+                return false;
+            }
+        }
+    }
+    // every arc leads to a more important node and every shortcut to one
+    // less important than both ends, made of two arcs that exist, so
+    // queries stay in bounds and unpacking terminates
+    for (const ArcList* list : {&up_, &down_}) {
+        for (uint32_t node = 0; node < n; node++) {
+            for (const Arc* arc = list->Begin(node); arc != list->End(node); arc++) {
+                if (arc->node >= n || rank_[arc->node] <= rank_[node]) {
+                    return false;
+                }
+                if (arc->middle == kInvalid) {
+                    continue;
+                }
+                const uint32_t from = list == &up_ ? node : arc->node;
+                const uint32_t to = list == &up_ ? arc->node : node;
+                if (arc->middle >= n || rank_[arc->middle] >= rank_[node] ||
+                    !findArc(from, arc->middle) || !findArc(arc->middle, to)) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void ContractionHierarchy::Save(const string& filename) const {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    writeValue(file, kFileMagic);
+    writeValue(file, kFileVersion);
+    writeValue(file, fingerprint_);
+    writeValue(file, numShortcuts_);
+    writeVector(file, rank_);
+    writeVector(file, up_.offsets);
+    writeVector(file, up_.arcs);
+    writeVector(file, down_.offsets);
+    writeVector(file, down_.arcs);
+    if (!file) {
+        throw std::runtime_error("unable to write contraction hierarchy " + filename);
+    }
+}
+
+float ContractionHierarchy::ShortestPath(uint32_t source, uint32_t target, vector<uint32_t>& path) const {
+    path.clear();
+    SearchWorkspace& forward = SearchWorkspace::ForCurrentThread(0);
+    SearchWorkspace& backward = SearchWorkspace::ForCurrentThread(1);
+    forward.Reset(NumNodes());
+    backward.Reset(NumNodes());
+    forward.Reach(source, 0, kInvalid);
+    forward.Heap().Push(source, 0);
+    backward.Reach(target, 0, kInvalid);
+    backward.Heap().Push(target, 0);
+
+    float best = kInfinity;
+    uint32_t meeting = kInvalid;
+    while (true) {
+        const float forwardKey = forward.Heap().Empty() ? kInfinity : forward.Heap().TopKey();
+        const float backwardKey = backward.Heap().Empty() ? kInfinity : backward.Heap().TopKey();
+        if (std::min(forwardKey, backwardKey) >= best) {
+            break;
+        }
+
+        const bool isForward = forwardKey <= backwardKey;
+        SearchWorkspace& ws = isForward ? forward : backward;
+        const SearchWorkspace& other = isForward ? backward : forward;
+        const ArcList& arcs = isForward ? up_ : down_;
+        const ArcList& opposite = isForward ? down_ : up_;
+
+        const uint32_t node = ws.Heap().Pop();
+        ws.Settle(node);
+        const float distance = ws.Distance(node);
+        if (distance + other.Distance(node) < best) {
+            best = distance + other.Distance(node);
+            meeting = node;
+        }
+
+        // stall on demand: a more important node already offers a shorter
+        // way here, so nothing reached from this node can be on the path
+        bool stalled = false;
+        for (const Arc* arc = opposite.Begin(node); arc != opposite.End(node) && !stalled; arc++) {
+            stalled = ws.Distance(arc->node) + arc->weight < distance;
+        }
+        if (stalled) {
+            continue;
+        }
+
+        for (const Arc* arc = arcs.Begin(node); arc != arcs.End(node); arc++) {
+            const float candidate = distance + arc->weight;
+            if (candidate < ws.Distance(arc->node)) {
+                ws.Reach(arc->node, candidate, node);
+                ws.Heap().Push(arc->node, candidate);
+            }
+        }
+    }
+
+    if (meeting == kInvalid) {
+        return kInfinity;
+    }
+
+    vector<uint32_t> hops;
+    forward.PathTo(meeting, hops);
+    for (uint32_t at = backward.Parent(meeting); at != kInvalid; at = backward.Parent(at)) {
+        hops.push_back(at);
+    }
+    path.push_back(hops[0]);
+    for (size_t i = 1; i < hops.size(); i++) {
+        unpack(hops[i-1], hops[i], path);
+    }
+    return best;
+}
+
+void ContractionHierarchy::upwardSearch(uint32_t start, const ArcList& arcs, const ArcList& opposite,
+                                        SearchWorkspace& ws, vector<uint32_t>& settled) const {
+    settled.clear();
+    ws.Reset(NumNodes());
+    IndexedHeap& heap = ws.Heap();
+    ws.Reach(start, 0, kInvalid);
+    heap.Push(start, 0);
+    while (!heap.Empty()) {
+        const uint32_t node = heap.Pop();
+        ws.Settle(node);
+        settled.push_back(node);
+        const float distance = ws.Distance(node);
+
+        bool stalled = false;
+        for (const Arc* arc = opposite.Begin(node); arc != opposite.End(node) && !stalled; arc++) {
+            stalled = ws.Distance(arc->node) + arc->weight < distance;
+        }
+        if (stalled) {
+            continue;
+        }
+        for (const Arc* arc = arcs.Begin(node); arc != arcs.End(node); arc++) {
+            const float candidate = distance + arc->weight;
+            if (candidate < ws.Distance(arc->node)) {
+                ws.Reach(arc->node, candidate, node);
+                heap.Push(arc->node, candidate);
+            }
+        }
+    }
+}
+
+vector<float> ContractionHierarchy::DistanceMatrix(const vector<uint32_t>& sources,
+                                                   const vector<uint32_t>& targets) const {
+    struct BucketEntry {
+        uint32_t node;
+        uint32_t column;
+        float distance;
+        bool operator<(const BucketEntry& other) const { return node < other.node; }
+    };
+
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread(0);
+    vector<uint32_t> settled;
+    vector<BucketEntry> buckets;
+    for (uint32_t column = 0; column < targets.size(); column++) {
+        upwardSearch(targets[column], down_, up_, ws, settled);
+        for (uint32_t node : settled) {
+            buckets.push_back({node, column, ws.Distance(node)});
+        }
+    }
+    std::sort(buckets.begin(), buckets.end());
+
+    vector<float> distances(sources.size() * targets.size(), kInfinity);
+    for (size_t row = 0; row < sources.size(); row++) {
+        float* distance = &distances[row * targets.size()];
+        upwardSearch(sources[row], up_, down_, ws, settled);
+        for (uint32_t node : settled) {
+            auto range = std::equal_range(buckets.begin(), buckets.end(), BucketEntry{node, 0, 0});
+            for (auto entry = range.first; entry != range.second; entry++) {
+                distance[entry->column] = std::min(distance[entry->column],
+                                                   ws.Distance(node) + entry->distance);
+            }
+        }
+    }
+    return distances;
+}
+
+const ContractionHierarchy::Arc* ContractionHierarchy::findArc(uint32_t from, uint32_t to) const {
+    // an arc is stored with its less important end
+    if (rank_[from] < rank_[to]) {
+        for (const Arc* arc = up_.Begin(from); arc != up_.End(from); arc++) {
+            if (arc->node == to) {
+                return arc;
+            }
+        }
+    } else {
+        for (const Arc* arc = down_.Begin(to); arc != down_.End(to); arc++) {
+            if (arc->node == from) {
+                return arc;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ContractionHierarchy::unpack(uint32_t from, uint32_t to, vector<uint32_t>& path) const {
+    // appends the original nodes after from, up to and including to
+    vector<std::pair<uint32_t, uint32_t> > pending(1, {from, to});
+    while (!pending.empty()) {
+        const std::pair<uint32_t, uint32_t> edge = pending.back();
+        pending.pop_back();
+        const Arc* arc = findArc(edge.first, edge.second);
+        if (arc->middle == kInvalid) {
+            path.push_back(edge.second);
+        } else {
+            pending.push_back({arc->middle, edge.second});
+            pending.push_back({edge.first, arc->middle});
+        }
+    }
+}
+
+vector<string> ContractionHierarchies::GetPath(const IGraph* graph, const string& from, const string& to) const {
+    const CompactGraph& compact = *graph->GetCompactGraph();
+    const uint32_t source = SearchEngine::RequireNode(compact, from, "from");
+    const uint32_t target = SearchEngine::RequireNode(compact, to, "to");
+
+    vector<uint32_t> path;
+    compact.GetContractionHierarchy()->ShortestPath(source, target, path);
+    return SearchEngine::ToNames(compact, path);
+}
+
+}
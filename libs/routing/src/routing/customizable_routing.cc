@@ -0,0 +1,393 @@
+#include "routing/customizable_routing.h"
+#include "routing/search_engine.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using std::string;
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const uint32_t kInvalid = CompactGraph::kInvalidNode;
+const float kInfinity = std::numeric_limits<float>::infinity();
+
+struct Range {
+    uint32_t begin;
+    uint32_t end;
+    int depth;
+    uint32_t code;
+};
+
+}
+
+OverlayGraph::OverlayGraph(const CompactGraph& graph, uint32_t cellSize, int levels)
+    : graph_(&graph), levels_(std::max(levels, 1)) {
+    const uint32_t n = graph.NumNodes();
+    cellSize = std::max(cellSize, 1u);
+
+    // bisection depth that gets every level 0 cell down to cellSize
+    int depth = 0;
+    while (depth < 31 && (uint64_t(n) + (uint64_t(1) << depth) - 1) >> depth > cellSize) {
+        depth++;
+    }
+    bits_ = std::max(1, (depth + levels_ - 1) / levels_);
+
+    // Split every range at the median of its longer side. All ranges go
+    // down to the same depth, so codes share a prefix exactly when the
+    // nodes share a cell.
+    code_.assign(n, 0);
+    vector<uint32_t> order(n);
+    for (uint32_t node = 0; node < n; node++) {
+        order[node] = node;
+    }
+    vector<Range> ranges = {{0, n, 0, 0}};
+    while (!ranges.empty()) {
+        const Range range = ranges.back();
+        ranges.pop_back();
+        if (range.depth == depth) {
+            for (uint32_t i = range.begin; i < range.end; i++) {
+                code_[order[i]] = range.code;
+            }
+            continue;
+        }
+
+        float min[3] = {kInfinity, kInfinity, kInfinity};
+        float max[3] = {-kInfinity, -kInfinity, -kInfinity};
+        for (uint32_t i = range.begin; i < range.end; i++) {
+            const float* p = graph.Position(order[i]);
+            for (int j = 0; j < 3; j++) {
+                min[j] = std::min(min[j], p[j]);
+                max[j] = std::max(max[j], p[j]);
+            }
+        }
+        int axis = 0;
+        for (int j = 1; j < 3; j++) {
+            if (max[j] - min[j] > max[axis] - min[axis]) {
+                axis = j;
+            }
+        }
+        const uint32_t middle = range.begin + (range.end - range.begin) / 2;
+        std::nth_element(order.begin() + range.begin, order.begin() + middle, order.begin() + range.end,
+                         [&](uint32_t a, uint32_t b) {
+                             const float pa = graph.Position(a)[axis], pb = graph.Position(b)[axis];
+                             return pa < pb || (pa == pb && a < b);
+                         });
+        ranges.push_back({range.begin, middle, range.depth + 1, range.code << 1});
+        ranges.push_back({middle, range.end, range.depth + 1, (range.code << 1) | 1});
+    }
+
+    numCells_.resize(levels_);
+    boundaryOffsets_.resize(levels_);
+    boundary_.resize(levels_);
+    slots_.resize(levels_);
+    cliqueOffsets_.resize(levels_);
+    for (int level = 0; level < levels_; level++) {
+        const int shift = level * bits_;
+        numCells_[level] = shift < depth ? (((uint32_t(1) << depth) - 1) >> shift) + 1 : 1;
+
+        vector<char> isBoundary(n, 0);
+        for (uint32_t node = 0; node < n; node++) {
+            for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+                const uint32_t next = graph.EdgeTarget(e);
+                if (Cell(level, node) != Cell(level, next)) {
+                    isBoundary[node] = 1;
+                    isBoundary[next] = 1;
+                }
+            }
+        }
+
+        vector<uint32_t>& offsets = boundaryOffsets_[level];
+        offsets.assign(numCells_[level] + 1, 0);
+        for (uint32_t node = 0; node < n; node++) {
+            if (isBoundary[node]) {
+                offsets[Cell(level, node) + 1]++;
+            }
+        }
+        for (uint32_t cell = 0; cell < numCells_[level]; cell++) {
+            offsets[cell + 1] += offsets[cell];
+        }
+        boundary_[level].resize(offsets.back());
+        slots_[level].assign(n, kInvalid);
+        vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        for (uint32_t node = 0; node < n; node++) {
+            if (isBoundary[node]) {
+                const uint32_t cell = Cell(level, node);
+                slots_[level][node] = fill[cell] - offsets[cell];
+                boundary_[level][fill[cell]++] = node;
+            }
+        }
+
+        cliqueOffsets_[level].assign(numCells_[level] + 1, 0);
+        for (uint32_t cell = 0; cell < numCells_[level]; cell++) {
+            const size_t k = NumBoundaryNodes(level, cell);
+            cliqueOffsets_[level][cell + 1] = cliqueOffsets_[level][cell] + k * k;
+        }
+    }
+}
+
+int OverlayGraph::QueryLevel(uint32_t node, uint32_t source, uint32_t target) const {
+    for (int level = levels_ - 1; level >= 0; level--) {
+        const uint32_t cell = Cell(level, node);
+        if (cell != Cell(level, source) && cell != Cell(level, target)) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+OverlayMetric::OverlayMetric(std::shared_ptr<const OverlayGraph> overlay, vector<float> weights)
+    : overlay_(std::move(overlay)), weights_(std::move(weights)) {
+    const OverlayGraph& o = *overlay_;
+    if (weights_.size() != o.Graph().NumEdges()) {
+        throw std::invalid_argument("need one weight per edge");
+    }
+    cliques_.resize(o.NumLevels());
+    vector<vector<char> > dirty(o.NumLevels());
+    for (int level = 0; level < o.NumLevels(); level++) {
+        cliques_[level].assign(o.CliqueSize(level), kInfinity);
+        dirty[level].assign(o.NumCells(level), 1);
+    }
+    customize(dirty);
+}
+
+OverlayMetric::OverlayMetric(const OverlayMetric& previous, const vector<std::pair<uint32_t, float> >& changes)
+    : overlay_(previous.overlay_), weights_(previous.weights_), cliques_(previous.cliques_) {
+    const OverlayGraph& o = *overlay_;
+    const CompactGraph& graph = o.Graph();
+    vector<vector<char> > dirty(o.NumLevels());
+    for (int level = 0; level < o.NumLevels(); level++) {
+        dirty[level].assign(o.NumCells(level), 0);
+    }
+
+    // an edge only shows up in the cliques of the cells that hold both of
+    // its ends, on every level from the one where it stops being cut
+    vector<uint32_t> source(graph.NumEdges());
+    for (uint32_t node = 0; node < graph.NumNodes(); node++) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            source[e] = node;
+        }
+    }
+    for (const auto& change : changes) {
+        if (change.first >= weights_.size()) {
+            throw std::invalid_argument("no edge " + std::to_string(change.first));
+        }
+        if (weights_[change.first] == change.second) {
+            continue;
+        }
+        weights_[change.first] = change.second;
+        const uint32_t from = source[change.first];
+        const uint32_t to = graph.EdgeTarget(change.first);
+        for (int level = 0; level < o.NumLevels(); level++) {
+            if (o.Cell(level, from) == o.Cell(level, to)) {
+                dirty[level][o.Cell(level, from)] = 1;
+            }
+        }
+    }
+    customize(dirty);
+}
+
+template <class Visit>
+void OverlayMetric::relax(uint32_t node, int level, const Visit& visit) const {
+    const OverlayGraph& o = *overlay_;
+    const CompactGraph& graph = o.Graph();
+    if (level < 0) {
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            visit(graph.EdgeTarget(e), weights_[e]);
+        }
+        return;
+    }
+
+    const uint32_t cell = o.Cell(level, node);
+    const uint32_t k = o.NumBoundaryNodes(level, cell);
+    const uint32_t* boundary = o.BoundaryBegin(level, cell);
+    const float* row = cliques_[level].data() + o.CliqueOffset(level, cell) + size_t(o.BoundarySlot(level, node)) * k;
+    for (uint32_t j = 0; j < k; j++) {
+        if (boundary[j] != node) {
+            visit(boundary[j], row[j]);
+        }
+    }
+    // edges inside the cell are covered by the clique
+    for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+        const uint32_t next = graph.EdgeTarget(e);
+        if (o.Cell(level, next) != cell) {
+            visit(next, weights_[e]);
+        }
+    }
+}
+
+void OverlayMetric::cellSearch(int level, uint32_t cell, uint32_t source, uint32_t stop, SearchWorkspace& ws) const {
+    const OverlayGraph& o = *overlay_;
+    ws.Reset(o.Graph().NumNodes());
+    IndexedHeap& open = ws.Heap();
+    ws.Reach(source, 0, kInvalid);
+    open.Push(source, 0);
+    while (!open.Empty()) {
+        const uint32_t node = open.Pop();
+        ws.Settle(node);
+        if (node == stop) {
+            return;
+        }
+        const float distance = ws.Distance(node);
+        relax(node, level - 1, [&](uint32_t next, float weight) {
+            if (o.Cell(level, next) != cell || ws.Settled(next)) {
+                return;
+            }
+            const float candidate = distance + weight;
+            if (candidate < ws.Distance(next)) {
+                ws.Reach(next, candidate, node);
+                open.Push(next, candidate);
+            }
+        });
+    }
+}
+
+void OverlayMetric::customize(const vector<vector<char> >& dirty) {
+    const OverlayGraph& o = *overlay_;
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread(1);
+    // every level is built from the finished level below
+    for (int level = 0; level < o.NumLevels(); level++) {
+        for (uint32_t cell = 0; cell < o.NumCells(level); cell++) {
+            if (!dirty[level][cell]) {
+                continue;
+            }
+            customizedCells_++;
+            const uint32_t k = o.NumBoundaryNodes(level, cell);
+            const uint32_t* boundary = o.BoundaryBegin(level, cell);
+            float* clique = cliques_[level].data() + o.CliqueOffset(level, cell);
+            for (uint32_t i = 0; i < k; i++) {
+                cellSearch(level, cell, boundary[i], kInvalid, ws);
+                for (uint32_t j = 0; j < k; j++) {
+                    clique[size_t(i) * k + j] = ws.Distance(boundary[j]);
+                }
+            }
+        }
+    }
+}
+
+void OverlayMetric::unpack(int level, uint32_t from, uint32_t to, vector<uint32_t>& path) const {
+    const OverlayGraph& o = *overlay_;
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread(1);
+    cellSearch(level, o.Cell(level, from), from, to, ws);
+    vector<uint32_t> arcs;
+    ws.PathTo(to, arcs);
+    for (size_t i = 1; i < arcs.size(); i++) {
+        if (level > 0 && o.Cell(level - 1, arcs[i-1]) == o.Cell(level - 1, arcs[i])) {
+            unpack(level - 1, arcs[i-1], arcs[i], path);
+        } else {
+            path.push_back(arcs[i]);
+        }
+    }
+}
+
+float OverlayMetric::ShortestPath(uint32_t source, uint32_t target, vector<uint32_t>& path) const {
+    const OverlayGraph& o = *overlay_;
+    path.clear();
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread();
+    ws.Reset(o.Graph().NumNodes());
+    IndexedHeap& open = ws.Heap();
+    ws.Reach(source, 0, kInvalid);
+    open.Push(source, 0);
+    bool found = false;
+    while (!open.Empty()) {
+        const uint32_t node = open.Pop();
+        ws.Settle(node);
+        if (node == target) {
+            found = true;
+            break;
+        }
+        const float distance = ws.Distance(node);
+        relax(node, o.QueryLevel(node, source, target), [&](uint32_t next, float weight) {
+            if (ws.Settled(next)) {
+                return;
+            }
+            const float candidate = distance + weight;
+            if (candidate < ws.Distance(next)) {
+                ws.Reach(next, candidate, node);
+                open.Push(next, candidate);
+            }
+        });
+    }
+    if (!found) {
+        return kInfinity;
+    }
+
+    const float length = ws.Distance(target);
+    vector<uint32_t> arcs;
+    ws.PathTo(target, arcs);
+    path.push_back(source);
+    for (size_t i = 1; i < arcs.size(); i++) {
+        const int level = o.QueryLevel(arcs[i-1], source, target);
+        if (level >= 0 && o.Cell(level, arcs[i-1]) == o.Cell(level, arcs[i])) {
+            unpack(level, arcs[i-1], arcs[i], path);
+        } else {
+            path.push_back(arcs[i]);
+        }
+    }
+    return length;
+}
+
+CustomizableRouting::CustomizableRouting(const CompactGraph& graph, uint32_t cellSize, int levels)
+    : graphVersion(graph.Version()) {
+    vector<float> lengths(graph.NumEdges());
+    for (uint32_t e = 0; e < graph.NumEdges(); e++) {
+        lengths[e] = graph.EdgeLength(e);
+    }
+    metric = std::make_shared<const OverlayMetric>(std::make_shared<const OverlayGraph>(graph, cellSize, levels),
+                                                   std::move(lengths));
+}
+
+std::shared_ptr<const OverlayMetric> CustomizableRouting::Metric() const {
+    std::lock_guard<std::mutex> lock(metricMutex);
+    return metric;
+}
+
+void CustomizableRouting::SetEdgeWeights(const vector<std::pair<uint32_t, float> >& changes) {
+    std::lock_guard<std::mutex> update(updateMutex);
+    apply(changes);
+}
+
+void CustomizableRouting::apply(const vector<std::pair<uint32_t, float> >& changes) const {
+    // updates build on each other, queries keep reading the old metric
+    auto next = std::make_shared<const OverlayMetric>(*Metric(), changes);
+    std::lock_guard<std::mutex> lock(metricMutex);
+    metric = std::move(next);
+}
+
+std::shared_ptr<const OverlayMetric> CustomizableRouting::current() const {
+    std::shared_ptr<const OverlayMetric> latest = Metric();
+    const CompactGraph& graph = latest->Overlay().Graph();
+    if (graph.Version() == graphVersion) {
+        return latest;
+    }
+    std::lock_guard<std::mutex> update(updateMutex);
+    const vector<EdgeChange> changes = graph.ChangesSince(graphVersion);
+    vector<std::pair<uint32_t, float> > weights;
+    for (const EdgeChange& change : changes) {
+        weights.emplace_back(change.edge, graph.EdgeLength(change.edge));
+    }
+    if (!weights.empty()) {
+        apply(weights);
+    }
+    graphVersion += changes.size();
+    return Metric();
+}
+
+vector<string> CustomizableRouting::GetPath(const IGraph* graph, const string& from, const string& to) const {
+    std::shared_ptr<const OverlayMetric> latest = current();
+    const CompactGraph& compact = latest->Overlay().Graph();
+    if (graph->GetCompactGraph() != &compact) {
+        throw std::invalid_argument("graph is not the one this strategy was partitioned for");
+    }
+    const uint32_t source = SearchEngine::RequireNode(compact, from, "from");
+    const uint32_t target = SearchEngine::RequireNode(compact, to, "to");
+
+    vector<uint32_t> path;
+    latest->ShortestPath(source, target, path);
+    return SearchEngine::ToNames(compact, path);
+}
+
+}
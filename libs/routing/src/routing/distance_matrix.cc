@@ -0,0 +1,83 @@
+#include "routing/distance_matrix.h"
+#include "routing/contraction_hierarchy.h"
+#include "routing/search_engine.h"
+
+#include <algorithm>
+#include <limits>
+
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+// Dijkstra from start, over the in edges if reverse is set, until every
+// node in sortedEnds is settled or nothing more is reachable.
+void oneToMany(const CompactGraph& graph, uint32_t start, bool reverse,
+               const vector<uint32_t>& sortedEnds, SearchWorkspace& ws) {
+    ws.Reset(graph.NumNodes());
+    IndexedHeap& heap = ws.Heap();
+    ws.Reach(start, 0, CompactGraph::kInvalidNode);
+    heap.Push(start, 0);
+    size_t remaining = sortedEnds.size();
+    while (!heap.Empty() && remaining > 0) {
+        const uint32_t node = heap.Pop();
+        ws.Settle(node);
+        if (std::binary_search(sortedEnds.begin(), sortedEnds.end(), node)) {
+            remaining--;
+        }
+
+        const float distance = ws.Distance(node);
+        const uint32_t begin = reverse ? graph.ReverseEdgeBegin(node) : graph.EdgeBegin(node);
+        const uint32_t end = reverse ? graph.ReverseEdgeEnd(node) : graph.EdgeEnd(node);
+        for (uint32_t e = begin; e < end; e++) {
+            const uint32_t edge = reverse ? graph.ReverseEdgeForward(e) : e;
+            const uint32_t next = reverse ? graph.ReverseEdgeSource(e) : graph.EdgeTarget(e);
+            const float candidate = distance + graph.EdgeLength(edge);
+            if (candidate < ws.Distance(next)) {
+                ws.Reach(next, candidate, node);
+                heap.Push(next, candidate);
+            }
+        }
+    }
+}
+
+vector<uint32_t> sortedUnique(vector<uint32_t> nodes) {
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return nodes;
+}
+
+}
+
+vector<float> DistanceMatrix::Compute(const CompactGraph& graph, const vector<uint32_t>& sources,
+                                      const vector<uint32_t>& targets) {
+    std::shared_ptr<const ContractionHierarchy> hierarchy = graph.FindContractionHierarchy();
+    if (hierarchy) {
+        return hierarchy->DistanceMatrix(sources, targets);
+    }
+
+    const size_t columns = targets.size();
+    vector<float> distances(sources.size() * columns, std::numeric_limits<float>::infinity());
+    SearchWorkspace& ws = SearchWorkspace::ForCurrentThread(0);
+    if (sources.size() <= columns) {
+        const vector<uint32_t> ends = sortedUnique(targets);
+        for (size_t row = 0; row < sources.size(); row++) {
+            oneToMany(graph, sources[row], false, ends, ws);
+            for (size_t column = 0; column < columns; column++) {
+                distances[row * columns + column] = ws.Distance(targets[column]);
+            }
+        }
+    } else {
+        const vector<uint32_t> ends = sortedUnique(sources);
+        for (size_t column = 0; column < columns; column++) {
+            oneToMany(graph, targets[column], true, ends, ws);
+            for (size_t row = 0; row < sources.size(); row++) {
+                distances[row * columns + column] = ws.Distance(sources[row]);
+            }
+        }
+    }
+    return distances;
+}
+
+}
@@ -0,0 +1,159 @@
+#include "routing/landmarks.h"
+#include "routing/shortest_path_tree.h"
+
+#include <limits>
+#include <random>
+
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+const uint32_t kInvalid = CompactGraph::kInvalidNode;
+const float kInfinity = std::numeric_limits<float>::infinity();
+
+uint32_t farthest(const vector<float>& distance) {
+    uint32_t best = kInvalid;
+    for (uint32_t node = 0; node < distance.size(); node++) {
+        if (distance[node] < kInfinity && distance[node] > 0 &&
+            (best == kInvalid || distance[node] > distance[best])) {
+            best = node;
+        }
+    }
+    return best;
+}
+
+}
+
+Landmarks::Landmarks(const CompactGraph& graph, int count, LandmarkSelection selection, unsigned seed)
+    : graph_(&graph), version_(graph.Version()) {
+    const uint32_t n = graph.NumNodes();
+    if (n == 0 || count <= 0) {
+        return;
+    }
+
+    std::mt19937 rng(seed);
+    vector<vector<float> > fromColumns, toColumns;
+    // distance from the closest landmark chosen so far
+    vector<float> nearest(n, kInfinity);
+    vector<char> isLandmark(n, 0);
+
+    auto add = [&](uint32_t landmark) {
+        landmarks_.push_back(landmark);
+        isLandmark[landmark] = 1;
+        fromColumns.push_back(ShortestPathTree(graph, landmark).Distances());
+        toColumns.push_back(ShortestPathTree(graph, landmark, kInfinity, true).Distances());
+        for (uint32_t node = 0; node < n; node++) {
+            nearest[node] = std::min(nearest[node], fromColumns.back()[node]);
+        }
+    };
+
+    // lower bound from the landmarks chosen so far, see LowerBound()
+    auto bound = [&](uint32_t node, uint32_t target) {
+        float result = 0;
+        for (size_t i = 0; i < landmarks_.size(); i++) {
+            const float forward = fromColumns[i][target] - fromColumns[i][node];
+            const float backward = toColumns[i][node] - toColumns[i][target];
+            if (forward > result && forward < kUnbounded) {
+                result = forward;
+            }
+            if (backward > result && backward < kUnbounded) {
+                result = backward;
+            }
+        }
+        return result;
+    };
+
+    if (selection == LandmarkSelection::kFarthest) {
+        // the farthest node from a random start seeds the set
+        const ShortestPathTree tree(graph, rng() % n);
+        uint32_t first = farthest(tree.Distances());
+        add(first == kInvalid ? tree.Source() : first);
+    }
+
+    vector<float> size(n);
+    vector<uint32_t> bestChild(n);
+    while (landmarks_.size() < static_cast<size_t>(count) && landmarks_.size() < n) {
+        uint32_t next = kInvalid;
+        if (selection == LandmarkSelection::kAvoid) {
+            // Grow a shortest path tree from a random root and weigh every
+            // node by how badly the current landmarks bound its distance.
+            // Subtrees that already contain a landmark are skipped; the
+            // heaviest remaining branch is followed down to a leaf.
+            const ShortestPathTree tree(graph, rng() % n);
+            const uint32_t root = tree.Source();
+            const vector<float>& distance = tree.Distances();
+            const vector<uint32_t>& parent = tree.Parents();
+            const vector<uint32_t>& order = tree.Order();
+            std::fill(size.begin(), size.end(), 0.0f);
+            vector<char> covered(isLandmark);
+            for (size_t i = order.size(); i-- > 0;) {
+                const uint32_t node = order[i];
+                size[node] = covered[node] ? 0 : size[node] + distance[node] - bound(root, node);
+                if (parent[node] != kInvalid) {
+                    covered[parent[node]] |= covered[node];
+                    size[parent[node]] += size[node];
+                }
+            }
+            std::fill(bestChild.begin(), bestChild.end(), kInvalid);
+            for (uint32_t node : order) {
+                const uint32_t up = parent[node];
+                if (up != kInvalid && size[node] > 0 &&
+                    (bestChild[up] == kInvalid || size[node] > size[bestChild[up]])) {
+                    bestChild[up] = node;
+                }
+            }
+            // the root itself is covered once there is any landmark
+            for (uint32_t at = bestChild[root]; at != kInvalid; at = bestChild[at]) {
+                next = at;
+            }
+        }
+        if (next == kInvalid || isLandmark[next]) {
+            next = farthest(nearest);
+        }
+        if (next == kInvalid) {
+            // every reachable node is already a landmark
+            break;
+        }
+        add(next);
+    }
+
+    const size_t k = landmarks_.size();
+    from_.resize(n * k);
+    to_.resize(n * k);
+    for (uint32_t node = 0; node < n; node++) {
+        for (size_t i = 0; i < k; i++) {
+            from_[node * k + i] = fromColumns[i][node];
+            to_[node * k + i] = toColumns[i][node];
+        }
+    }
+}
+
+float LandmarkHeuristic::Calculate(const std::vector<float>& a, const std::vector<float>& b) const {
+    if (a.size() < 3 || b.size() < 3) {
+        return straightLine.Calculate(a, b);
+    }
+    return Calculate(a.data(), b.data());
+}
+
+float LandmarkHeuristic::Calculate(const float* a, const float* b) const {
+    const CompactGraph& graph = landmarks->Graph();
+    const SpatialIndex& index = graph.GetSpatialIndex();
+    auto nodeAt = [&](const float* point) {
+        uint32_t node = index.Nearest(point);
+        if (node == SpatialIndex::kNone) {
+            return kInvalid;
+        }
+        const float* p = graph.Position(node);
+        return p[0] == point[0] && p[1] == point[1] && p[2] == point[2] ? node : kInvalid;
+    };
+    const uint32_t from = nodeAt(a);
+    const uint32_t to = nodeAt(b);
+    if (from == kInvalid || to == kInvalid) {
+        return straightLine.Calculate(a, b);
+    }
+    return Estimate(from, to);
+}
+
+}
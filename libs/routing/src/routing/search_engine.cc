@@ -0,0 +1,307 @@
+#include "routing/search_engine.h"
+#include "routing/landmarks.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <typeinfo>
+
+using std::string;
+using std::vector;
+
+namespace routing {
+
+void IndexedHeap::Resize(uint32_t numNodes) {
+    if (position_.size() < numNodes) {
+        position_.resize(numNodes, kNotInHeap);
+    }
+}
+
+void IndexedHeap::Clear() {
+    for (const Item& item : items_) {
+        position_[item.node] = kNotInHeap;
+    }
+    items_.clear();
+}
+
+void IndexedHeap::Push(uint32_t node, float key) {
+    uint32_t i = position_[node];
+    if (i == kNotInHeap) {
+        items_.push_back({key, node});
+        position_[node] = static_cast<uint32_t>(items_.size() - 1);
+        siftUp(items_.size() - 1);
+    } else if (key < items_[i].key) {
+        items_[i].key = key;
+        siftUp(i);
+    }
+}
+
+uint32_t IndexedHeap::Pop() {
+    const uint32_t top = items_.front().node;
+    position_[top] = kNotInHeap;
+    const Item last = items_.back();
+    items_.pop_back();
+    if (!items_.empty()) {
+        place(0, last);
+        siftDown(0);
+    }
+    return top;
+}
+
+void IndexedHeap::siftUp(size_t i) {
+    const Item item = items_[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!(item.key < items_[parent].key)) {
+            break;
+        }
+        place(i, items_[parent]);
+        i = parent;
+    }
+    place(i, item);
+}
+
+void IndexedHeap::siftDown(size_t i) {
+    const Item item = items_[i];
+    const size_t n = items_.size();
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && items_[child + 1].key < items_[child].key) {
+            child++;
+        }
+        if (!(items_[child].key < item.key)) {
+            break;
+        }
+        place(i, items_[child]);
+        i = child;
+    }
+    place(i, item);
+}
+
+SearchWorkspace& SearchWorkspace::ForCurrentThread(int slot) {
+    thread_local SearchWorkspace workspaces[kSlots];
+    return workspaces[slot];
+}
+
+void SearchWorkspace::Reset(uint32_t numNodes) {
+    if (reached_.size() < numNodes) {
+        reached_.resize(numNodes, 0);
+        settled_.resize(numNodes, 0);
+        distance_.resize(numNodes);
+        parent_.resize(numNodes);
+        queue_.reserve(numNodes);
+    }
+    heap_.Resize(numNodes);
+    heap_.Clear();
+    queue_.clear();
+    settledCount_ = 0;
+    stop_ = RouteStatus::kFound;
+
+    generation_++;
+    if (generation_ == 0) {
+        // wrapped around, old stamps could look current again
+        std::fill(reached_.begin(), reached_.end(), 0);
+        std::fill(settled_.begin(), settled_.end(), 0);
+        generation_ = 1;
+    }
+}
+
+void SearchWorkspace::SetBudget(const SearchBudget& budget) {
+    budget_ = budget;
+    limited_ = !budget.Unlimited();
+    polls_ = 0;
+    start_ = std::chrono::steady_clock::now();
+    // a query that does not reset the workspace must not see the outcome
+    // of the one before
+    stop_ = RouteStatus::kFound;
+}
+
+bool SearchWorkspace::exhausted(uint32_t extraSettled) {
+    if (budget_.cancel && budget_.cancel->load(std::memory_order_relaxed)) {
+        stop_ = RouteStatus::kCancelled;
+    } else if (budget_.maxSettled > 0 && settledCount_ + extraSettled >= budget_.maxSettled) {
+        stop_ = RouteStatus::kBudgetExceeded;
+    } else if (budget_.maxMilliseconds > 0 && ++polls_ % 64 == 0 &&
+               std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_).count() >=
+                   budget_.maxMilliseconds) {
+        stop_ = RouteStatus::kBudgetExceeded;
+    }
+    return Stopped();
+}
+
+void SearchWorkspace::PathTo(uint32_t node, vector<uint32_t>& path) const {
+    path.clear();
+    for (uint32_t at = node; at != CompactGraph::kInvalidNode; at = Parent(at)) {
+        path.push_back(at);
+    }
+    std::reverse(path.begin(), path.end());
+}
+
+namespace {
+
+// Fallbacks for metrics the engine does not know, one virtual call each.
+struct FunctionCost {
+    const CompactGraph& graph;
+    const DistanceFunction& cost;
+    float operator()(uint32_t from, uint32_t edge) const {
+        if (!graph.EdgeOpen(edge)) {
+            return std::numeric_limits<float>::infinity();
+        }
+        return cost.Calculate(graph.Position(from), graph.Position(graph.EdgeTarget(edge)));
+    }
+};
+
+struct FunctionHeuristic {
+    const CompactGraph& graph;
+    const DistanceFunction& heuristic;
+    const float* target;
+    float operator()(uint32_t node) const {
+        return heuristic.Calculate(graph.Position(node), target);
+    }
+};
+
+struct LandmarkEstimate {
+    const LandmarkHeuristic& heuristic;
+    uint32_t target;
+    float operator()(uint32_t node) const { return heuristic.Estimate(node, target); }
+};
+
+// True if function is the built in class or the adapter for Policy.
+template <class Policy, class Builtin = void>
+bool isPolicy(const DistanceFunction& function) {
+    return typeid(function) == typeid(PolicyDistance<Policy>) ||
+           (!std::is_void<Builtin>::value && typeid(function) == typeid(Builtin));
+}
+
+template <class Cost>
+bool aStarWithHeuristic(const CompactGraph& graph, uint32_t source, uint32_t target,
+                        const Cost& cost, const DistanceFunction& heuristic, SearchWorkspace& ws) {
+    const float* goal = graph.Position(target);
+    if (isPolicy<ZeroPolicy, ZeroDistance>(heuristic)) {
+        return SearchEngine::AStarSearch(graph, source, target, cost, PolicyEstimate<ZeroPolicy>{graph, goal}, ws);
+    }
+    if (isPolicy<EuclideanPolicy, EuclideanDistance>(heuristic)) {
+        return SearchEngine::AStarSearch(graph, source, target, cost, PolicyEstimate<EuclideanPolicy>{graph, goal}, ws);
+    }
+    if (isPolicy<ManhattanPolicy>(heuristic)) {
+        return SearchEngine::AStarSearch(graph, source, target, cost, PolicyEstimate<ManhattanPolicy>{graph, goal}, ws);
+    }
+    if (typeid(heuristic) == typeid(LandmarkHeuristic)) {
+        const LandmarkHeuristic& landmarks = static_cast<const LandmarkHeuristic&>(heuristic);
+        if (&landmarks.GetLandmarks().Graph() == &graph) {
+            return SearchEngine::AStarSearch(graph, source, target, cost, LandmarkEstimate{landmarks, target}, ws);
+        }
+    }
+    return SearchEngine::AStarSearch(graph, source, target, cost, FunctionHeuristic{graph, heuristic, goal}, ws);
+}
+
+}
+
+bool SearchEngine::ShortestPath(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                const DistanceFunction& cost, const DistanceFunction& heuristic,
+                                SearchWorkspace& workspace) {
+    workspace.Reset(graph.NumNodes());
+    if (isPolicy<EuclideanPolicy, EuclideanDistance>(cost)) {
+        return aStarWithHeuristic(graph, source, target, PolicyEdgeCost<EuclideanPolicy>{graph}, heuristic, workspace);
+    }
+    if (isPolicy<ManhattanPolicy>(cost)) {
+        return aStarWithHeuristic(graph, source, target, PolicyEdgeCost<ManhattanPolicy>{graph}, heuristic, workspace);
+    }
+    return aStarWithHeuristic(graph, source, target, FunctionCost{graph, cost}, heuristic, workspace);
+}
+
+bool SearchEngine::BreadthFirst(const CompactGraph& graph, uint32_t source, uint32_t target,
+                                SearchWorkspace& workspace) {
+    workspace.Reset(graph.NumNodes());
+    vector<uint32_t>& queue = workspace.Queue();
+    workspace.Reach(source, 0, CompactGraph::kInvalidNode);
+    if (source == target) {
+        return true;
+    }
+    queue.push_back(source);
+
+    // the queue never holds a node twice, so a read cursor replaces pops
+    for (size_t head = 0; head < queue.size(); head++) {
+        const uint32_t node = queue[head];
+        workspace.Settle(node);
+        if (workspace.Exhausted()) {
+            return false;
+        }
+        const float hops = workspace.Distance(node) + 1;
+        for (uint32_t e = graph.EdgeBegin(node); e < graph.EdgeEnd(node); e++) {
+            const uint32_t next = graph.EdgeTarget(e);
+            if (workspace.Reached(next) || !graph.EdgeOpen(e)) {
+                continue;
+            }
+            workspace.Reach(next, hops, node);
+            if (next == target) {
+                return true;
+            }
+            queue.push_back(next);
+        }
+    }
+    return false;
+}
+
+bool SearchEngine::DepthFirst(const CompactGraph& graph, uint32_t source, uint32_t target,
+                              SearchWorkspace& workspace) {
+    workspace.Reset(graph.NumNodes());
+    vector<uint32_t>& stack = workspace.Queue();
+    workspace.Reach(source, 0, CompactGraph::kInvalidNode);
+    workspace.Settle(source);
+    if (source == target) {
+        return true;
+    }
+    stack.push_back(graph.EdgeBegin(source));
+
+    while (!stack.empty()) {
+        // the cursor below the top one points at the edge into this node
+        const uint32_t node = stack.size() == 1 ? source : graph.EdgeTarget(stack[stack.size() - 2]);
+        uint32_t& edge = stack.back();
+        while (edge < graph.EdgeEnd(node) &&
+               (workspace.Reached(graph.EdgeTarget(edge)) || !graph.EdgeOpen(edge))) {
+            edge++;
+        }
+        if (edge == graph.EdgeEnd(node)) {
+            stack.pop_back();
+            if (!stack.empty()) {
+                stack.back()++;
+            }
+            continue;
+        }
+
+        const uint32_t next = graph.EdgeTarget(edge);
+        workspace.Reach(next, static_cast<float>(stack.size()), node);
+        workspace.Settle(next);
+        if (next == target) {
+            return true;
+        }
+        if (workspace.Exhausted()) {
+            return false;
+        }
+        stack.push_back(graph.EdgeBegin(next));
+    }
+    return false;
+}
+
+uint32_t SearchEngine::RequireNode(const CompactGraph& graph, const string& name, const string& role) {
+    uint32_t node = graph.IndexOf(name);
+    if (node == CompactGraph::kInvalidNode) {
+        throw std::invalid_argument("'" + role + "' node not found in graph: " + name);
+    }
+    return node;
+}
+
+vector<string> SearchEngine::ToNames(const CompactGraph& graph, const vector<uint32_t>& path) {
+    vector<string> names;
+    names.reserve(path.size());
+    for (uint32_t node : path) {
+        names.push_back(graph.NameOf(node));
+    }
+    return names;
+}
+
+}
@@ -0,0 +1,69 @@
+#include "routing/shortest_path_tree.h"
+#include "routing/search_engine.h"
+
+#include <algorithm>
+
+using std::vector;
+
+namespace routing {
+
+ShortestPathTree::ShortestPathTree(const CompactGraph& graph, uint32_t source, float maxDistance, bool reverse)
+    : source_(source), reverse_(reverse) {
+    const uint32_t n = graph.NumNodes();
+    distance_.assign(n, std::numeric_limits<float>::infinity());
+    parent_.assign(n, CompactGraph::kInvalidNode);
+
+    // settled nodes are exactly the ones appended to order_
+    vector<char> settled(n, 0);
+    IndexedHeap heap;
+    heap.Resize(n);
+    distance_[source] = 0;
+    heap.Push(source, 0);
+    while (!heap.Empty() && heap.TopKey() <= maxDistance) {
+        const uint32_t node = heap.Pop();
+        settled[node] = 1;
+        order_.push_back(node);
+
+        const uint32_t begin = reverse ? graph.ReverseEdgeBegin(node) : graph.EdgeBegin(node);
+        const uint32_t end = reverse ? graph.ReverseEdgeEnd(node) : graph.EdgeEnd(node);
+        for (uint32_t e = begin; e < end; e++) {
+            const uint32_t edge = reverse ? graph.ReverseEdgeForward(e) : e;
+            const uint32_t next = reverse ? graph.ReverseEdgeSource(e) : graph.EdgeTarget(e);
+            const float candidate = distance_[node] + graph.EdgeLength(edge);
+            if (!settled[next] && candidate < distance_[next]) {
+                distance_[next] = candidate;
+                parent_[next] = node;
+                heap.Push(next, candidate);
+            }
+        }
+    }
+
+    // labels left on the frontier are beyond maxDistance
+    while (!heap.Empty()) {
+        const uint32_t node = heap.Pop();
+        distance_[node] = std::numeric_limits<float>::infinity();
+        parent_[node] = CompactGraph::kInvalidNode;
+    }
+}
+
+vector<uint32_t> ShortestPathTree::Within(float distance) const {
+    auto end = std::upper_bound(order_.begin(), order_.end(), distance,
+                                [this](float limit, uint32_t node) { return limit < distance_[node]; });
+    return vector<uint32_t>(order_.begin(), end);
+}
+
+vector<uint32_t> ShortestPathTree::Path(uint32_t node) const {
+    vector<uint32_t> path;
+    if (!Reachable(node)) {
+        return path;
+    }
+    for (uint32_t at = node; at != CompactGraph::kInvalidNode; at = parent_[at]) {
+        path.push_back(at);
+    }
+    if (!reverse_) {
+        std::reverse(path.begin(), path.end());
+    }
+    return path;
+}
+
+}
@@ -1,12 +1,15 @@
 #include "routing_api.h"
 #include "parsers/osm/osm_graph_factory.h"
 #include "parsers/obj/obj_graph_factory.h"
+#include "parsers/binary/binary_graph_factory.h"
+#include "util/thread_pool.h"
 
 namespace routing {
 
 RoutingAPI::RoutingAPI() {
     factories.push_back(new OSMGraphFactory());
     factories.push_back(new ObjGraphFactory());
+    factories.push_back(new BinaryGraphFactory());
 }
 
 RoutingAPI::~RoutingAPI() {
@@ -18,6 +21,12 @@ RoutingAPI::~RoutingAPI() {
 IGraph* RoutingAPI::LoadFromFile(const std::string& file) const {
     for (int i = 0; i < factories.size(); i++) {
         IGraph* graph = factories[i]->Create(file);
+        const CompactGraph* compact = graph ? graph->GetCompactGraph() : NULL;
+        if (graph && nodeOrder != NodeOrder::kFile && compact == graph) {
+            IGraph* renumbered = compact->Renumbered(GraphOrder::Compute(*compact, nodeOrder));
+            delete graph;
+            return renumbered;
+        }
         if (graph) {
             return graph;
         }
@@ -30,4 +39,45 @@ void RoutingAPI::AddFactory(const IGraphFactory* factory) {
     factories.push_back(factory);
 }
 
-}
\ No newline at end of file
+void RoutingAPI::SetThreads(unsigned count) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (count != threads) {
+        threads = count;
+        threadPool.reset();
+    }
+}
+
+ThreadPool& RoutingAPI::pool() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (!threadPool) {
+        threadPool.reset(new ThreadPool(threads));
+    }
+    return *threadPool;
+}
+
+std::vector<SharedPath> RoutingAPI::GetPaths(const IGraph* graph, const std::vector<PathRequest>& requests) {
+    std::vector<SharedPath> paths(requests.size());
+    // searches use the workspace of the thread they run on, see
+    // SearchWorkspace::ForCurrentThread()
+    pool().Run(requests.size(), [&](size_t i) {
+        paths[i] = graph->GetSharedPath(requests[i].src, requests[i].dest, *requests[i].strategy);
+    });
+    return paths;
+}
+
+std::vector<std::future<SharedPath> > RoutingAPI::SubmitPaths(const IGraph* graph, std::vector<PathRequest> requests) {
+    std::vector<std::future<SharedPath> > futures;
+    futures.reserve(requests.size());
+    ThreadPool& workers = pool();
+    for (PathRequest& request : requests) {
+        auto query = std::make_shared<std::packaged_task<SharedPath()> >(
+            [graph, request = std::move(request)]() {
+                return graph->GetSharedPath(request.src, request.dest, *request.strategy);
+            });
+        futures.push_back(query->get_future());
+        workers.Post([query]() { (*query)(); });
+    }
+    return futures;
+}
+
+}
@@ -0,0 +1,59 @@
+#include "routing_strategy.h"
+#include "impl/compact_graph.h"
+#include "routing/search_engine.h"
+
+#include <limits>
+
+namespace routing {
+
+namespace {
+
+// Clears the budget again however the query ends.
+class BudgetScope {
+public:
+    BudgetScope(SearchWorkspace& workspace, const SearchBudget& budget) : workspace(workspace) {
+        workspace.SetBudget(budget);
+    }
+    ~BudgetScope() { workspace.ClearBudget(); }
+
+private:
+    SearchWorkspace& workspace;
+};
+
+}
+
+RouteResult RoutingStrategy::GetRoute(const IGraph* graph, const std::string& from, const std::string& to,
+                                      const SearchBudget& budget) const {
+    SearchWorkspace& workspace = SearchWorkspace::ForCurrentThread();
+    RouteResult result;
+    {
+        BudgetScope scope(workspace, budget);
+        result.path = GetPath(graph, from, to);
+    }
+    if (!workspace.Stopped()) {
+        result.status = result.path.empty() ? RouteStatus::kUnreachable : RouteStatus::kFound;
+        return result;
+    }
+
+    result.status = workspace.StopReason();
+    if (result.path.empty()) {
+        // the reached node nearest to the target, the workspace still holds
+        // the search that gave up
+        const CompactGraph& compact = *graph->GetCompactGraph();
+        const Point3 target = compact.PointAt(compact.IndexOf(to));
+        uint32_t nearest = compact.IndexOf(from);
+        float best = std::numeric_limits<float>::infinity();
+        for (uint32_t node = 0; node < compact.NumNodes(); node++) {
+            if (workspace.Reached(node) && compact.PointAt(node).distanceBetween(target) < best) {
+                best = compact.PointAt(node).distanceBetween(target);
+                nearest = node;
+            }
+        }
+        std::vector<uint32_t> path;
+        workspace.PathTo(nearest, path);
+        result.path = SearchEngine::ToNames(compact, path);
+    }
+    return result;
+}
+
+}
@@ -0,0 +1,182 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace routing {
+
+SpatialIndex::SpatialIndex(const std::vector<float>& positions)
+    : SpatialIndex(positions.data(), static_cast<uint32_t>(positions.size() / 3)) {}
+
+SpatialIndex::SpatialIndex(const float* positions, uint32_t n) {
+    ids_.resize(n);
+    std::iota(ids_.begin(), ids_.end(), 0);
+    points_.assign(positions, positions + 3 * size_t(n));
+    axes_.assign(n, 0);
+    build(0, n);
+
+    // store the points in tree order so queries walk memory linearly
+    std::vector<float> ordered(3 * size_t(n));
+    for (uint32_t slot = 0; slot < n; slot++) {
+        std::copy_n(&positions[3 * size_t(ids_[slot])], 3, &ordered[3 * size_t(slot)]);
+    }
+    points_.swap(ordered);
+}
+
+void SpatialIndex::build(uint32_t lo, uint32_t hi) {
+    if (hi - lo <= 1) {
+        return;
+    }
+
+    // split along the axis with the largest spread
+    float min[3] = {points_[3*ids_[lo]], points_[3*ids_[lo]+1], points_[3*ids_[lo]+2]};
+    float max[3] = {min[0], min[1], min[2]};
+    for (uint32_t i = lo + 1; i < hi; i++) {
+        for (int j = 0; j < 3; j++) {
+            float v = points_[3*size_t(ids_[i])+j];
+            min[j] = std::min(min[j], v);
+            max[j] = std::max(max[j], v);
+        }
+    }
+    uint8_t axis = 0;
+    for (uint8_t j = 1; j < 3; j++) {
+        if (max[j] - min[j] > max[axis] - min[axis]) {
+            axis = j;
+        }
+    }
+
+    const uint32_t mid = lo + (hi - lo) / 2;
+    std::nth_element(ids_.begin() + lo, ids_.begin() + mid, ids_.begin() + hi,
+        [&](uint32_t a, uint32_t b) {
+            return points_[3*size_t(a)+axis] < points_[3*size_t(b)+axis];
+        });
+    axes_[mid] = axis;
+    build(lo, mid);
+    build(mid + 1, hi);
+}
+
+float SpatialIndex::distance2(uint32_t slot, const float point[3]) const {
+    const float* p = &points_[3*size_t(slot)];
+    float dx = p[0] - point[0];
+    float dy = p[1] - point[1];
+    float dz = p[2] - point[2];
+    return dx*dx + dy*dy + dz*dz;
+}
+
+uint32_t SpatialIndex::Nearest(const float point[3]) const {
+    if (ids_.empty()) {
+        return kNone;
+    }
+    Candidate best = {distance2(0, point), ids_[0]};
+    nearest(0, Size(), point, best);
+    return best.id;
+}
+
+void SpatialIndex::nearest(uint32_t lo, uint32_t hi, const float point[3], Candidate& best) const {
+    if (lo >= hi) {
+        return;
+    }
+    const uint32_t mid = lo + (hi - lo) / 2;
+    Candidate here = {distance2(mid, point), ids_[mid]};
+    if (here < best) {
+        best = here;
+    }
+    if (hi - lo == 1) {
+        return;
+    }
+
+    const uint8_t axis = axes_[mid];
+    const float diff = point[axis] - points_[3*size_t(mid)+axis];
+    if (diff < 0) {
+        nearest(lo, mid, point, best);
+        if (diff*diff <= best.distance2) nearest(mid + 1, hi, point, best);
+    } else {
+        nearest(mid + 1, hi, point, best);
+        if (diff*diff <= best.distance2) nearest(lo, mid, point, best);
+    }
+}
+
+std::vector<uint32_t> SpatialIndex::KNearest(const float point[3], uint32_t k) const {
+    std::vector<Candidate> heap;
+    if (k > 0) {
+        heap.reserve(std::min(k, Size()));
+        kNearest(0, Size(), point, k, heap);
+    }
+    std::sort_heap(heap.begin(), heap.end());
+
+    std::vector<uint32_t> result;
+    result.reserve(heap.size());
+    for (const Candidate& c : heap) {
+        result.push_back(c.id);
+    }
+    return result;
+}
+
+void SpatialIndex::kNearest(uint32_t lo, uint32_t hi, const float point[3], uint32_t k,
+                            std::vector<Candidate>& heap) const {
+    if (lo >= hi) {
+        return;
+    }
+    const uint32_t mid = lo + (hi - lo) / 2;
+    Candidate here = {distance2(mid, point), ids_[mid]};
+    if (heap.size() < k) {
+        heap.push_back(here);
+        std::push_heap(heap.begin(), heap.end());
+    } else if (here < heap.front()) {
+        std::pop_heap(heap.begin(), heap.end());
+        heap.back() = here;
+        std::push_heap(heap.begin(), heap.end());
+    }
+    if (hi - lo == 1) {
+        return;
+    }
+
+    const uint8_t axis = axes_[mid];
+    const float diff = point[axis] - points_[3*size_t(mid)+axis];
+    uint32_t nearLo = lo, nearHi = mid, farLo = mid + 1, farHi = hi;
+    if (diff >= 0) {
+        std::swap(nearLo, farLo);
+        std::swap(nearHi, farHi);
+    }
+    kNearest(nearLo, nearHi, point, k, heap);
+    if (heap.size() < k || diff*diff <= heap.front().distance2) {
+        kNearest(farLo, farHi, point, k, heap);
+    }
+}
+
+std::vector<uint32_t> SpatialIndex::WithinRadius(const float point[3], float radius) const {
+    std::vector<Candidate> found;
+    if (radius >= 0) {
+        withinRadius(0, Size(), point, radius*radius, found);
+    }
+    std::sort(found.begin(), found.end());
+
+    std::vector<uint32_t> result;
+    result.reserve(found.size());
+    for (const Candidate& c : found) {
+        result.push_back(c.id);
+    }
+    return result;
+}
+
+void SpatialIndex::withinRadius(uint32_t lo, uint32_t hi, const float point[3], float radius2,
+                                std::vector<Candidate>& out) const {
+    if (lo >= hi) {
+        return;
+    }
+    const uint32_t mid = lo + (hi - lo) / 2;
+    float d2 = distance2(mid, point);
+    if (d2 <= radius2) {
+        out.push_back({d2, ids_[mid]});
+    }
+    if (hi - lo == 1) {
+        return;
+    }
+
+    const uint8_t axis = axes_[mid];
+    const float diff = point[axis] - points_[3*size_t(mid)+axis];
+    if (diff < 0 || diff*diff <= radius2) withinRadius(lo, mid, point, radius2, out);
+    if (diff >= 0 || diff*diff <= radius2) withinRadius(mid + 1, hi, point, radius2, out);
+}
+
+}
@@ -0,0 +1,150 @@
+#include "util/polyline.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using std::string;
+using std::vector;
+
+namespace routing {
+
+namespace {
+
+float component(const vector<float>& point, size_t j) {
+    return j < point.size() ? point[j] : 0.0f;
+}
+
+// Distance from p to the segment from a to b.
+float segmentDistance(const vector<float>& p, const vector<float>& a, const vector<float>& b) {
+    float ab[3], ap[3];
+    float lengthSquared = 0, dot = 0;
+    for (int j = 0; j < 3; j++) {
+        ab[j] = component(b, j) - component(a, j);
+        ap[j] = component(p, j) - component(a, j);
+        lengthSquared += ab[j] * ab[j];
+        dot += ab[j] * ap[j];
+    }
+    const float t = lengthSquared > 0 ? std::fmax(0.0f, std::fmin(1.0f, dot / lengthSquared)) : 0.0f;
+    float sum = 0;
+    for (int j = 0; j < 3; j++) {
+        const float d = ap[j] - t * ab[j];
+        sum += d * d;
+    }
+    return std::sqrt(sum);
+}
+
+void encodeValue(int64_t value, string& out) {
+    uint64_t bits = value < 0 ? ~(uint64_t(value) << 1) : uint64_t(value) << 1;
+    while (bits >= 0x20) {
+        out += static_cast<char>((0x20 | (bits & 0x1f)) + 63);
+        bits >>= 5;
+    }
+    out += static_cast<char>(bits + 63);
+}
+
+int64_t decodeValue(const string& in, size_t& at) {
+    uint64_t bits = 0;
+    int shift = 0;
+    while (true) {
+        if (at >= in.size() || shift > 60) {
+            throw std::invalid_argument("truncated encoded polyline");
+        }
+        const int chunk = static_cast<unsigned char>(in[at++]) - 63;
+        if (chunk < 0 || chunk >= 0x40) {
+            throw std::invalid_argument("invalid character in encoded polyline");
+        }
+        bits |= uint64_t(chunk & 0x1f) << shift;
+        shift += 5;
+        if (chunk < 0x20) {
+            break;
+        }
+    }
+    return bits & 1 ? ~int64_t(bits >> 1) : int64_t(bits >> 1);
+}
+
+}
+
+vector<uint32_t> Polyline::SimplifyIndices(const vector<vector<float> >& path, float tolerance) {
+    vector<uint32_t> kept;
+    if (path.size() <= 2) {
+        for (uint32_t i = 0; i < path.size(); i++) {
+            kept.push_back(i);
+        }
+        return kept;
+    }
+
+    vector<char> keep(path.size(), 0);
+    keep.front() = keep.back() = 1;
+    // ranges still to split, handled with a stack so long paths cannot
+    // overflow the call stack
+    vector<std::pair<uint32_t, uint32_t> > ranges = {{0, static_cast<uint32_t>(path.size() - 1)}};
+    while (!ranges.empty()) {
+        const uint32_t first = ranges.back().first;
+        const uint32_t last = ranges.back().second;
+        ranges.pop_back();
+
+        uint32_t farthest = first;
+        float farthestDistance = tolerance;
+        for (uint32_t i = first + 1; i < last; i++) {
+            const float distance = segmentDistance(path[i], path[first], path[last]);
+            if (distance > farthestDistance) {
+                farthest = i;
+                farthestDistance = distance;
+            }
+        }
+        if (farthest != first) {
+            keep[farthest] = 1;
+            ranges.push_back({first, farthest});
+            ranges.push_back({farthest, last});
+        }
+    }
+
+    for (uint32_t i = 0; i < path.size(); i++) {
+        if (keep[i]) {
+            kept.push_back(i);
+        }
+    }
+    return kept;
+}
+
+vector<vector<float> > Polyline::Simplify(const vector<vector<float> >& path, float tolerance) {
+    vector<vector<float> > result;
+    for (uint32_t i : SimplifyIndices(path, tolerance)) {
+        result.push_back(path[i]);
+    }
+    return result;
+}
+
+string Polyline::Encode(const vector<vector<float> >& path, int precision) {
+    const double scale = std::pow(10.0, precision);
+    string out;
+    out.reserve(path.size() * 9);
+    int64_t previous[3] = {0, 0, 0};
+    for (const vector<float>& point : path) {
+        for (int j = 0; j < 3; j++) {
+            const int64_t value = std::llround(component(point, j) * scale);
+            encodeValue(value - previous[j], out);
+            previous[j] = value;
+        }
+    }
+    return out;
+}
+
+vector<vector<float> > Polyline::Decode(const string& encoded, int precision) {
+    const double scale = std::pow(10.0, precision);
+    vector<vector<float> > path;
+    int64_t value[3] = {0, 0, 0};
+    size_t at = 0;
+    while (at < encoded.size()) {
+        vector<float> point(3);
+        for (int j = 0; j < 3; j++) {
+            value[j] += decodeValue(encoded, at);
+            point[j] = static_cast<float>(value[j] / scale);
+        }
+        path.push_back(std::move(point));
+    }
+    return path;
+}
+
+}
@@ -0,0 +1,23 @@
+#ifndef BIDIRECTIONAL_STRATEGY_H_
+#define BIDIRECTIONAL_STRATEGY_H_
+
+#include "PathStrategy.h"
+#include "graph.h"
+
+/**
+ * @brief this class inherits from the PathStrategy class and is responsible for
+ * generating the bidirectional astar path that the drone will take.
+ */
+class BidirectionalStrategy : public PathStrategy {
+ public:
+  /**
+   * @brief Construct a new Bidirectional Strategy object
+   *
+   * @param position Current position
+   * @param destination End destination
+   * @param graph Graph/Nodes of the map
+   */
+  BidirectionalStrategy(Vector3 position, Vector3 destination,
+                        const routing::IGraph *graph);
+};
+#endif  // BIDIRECTIONAL_STRATEGY_H_
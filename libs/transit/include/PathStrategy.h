@@ -1,7 +1,12 @@
 #ifndef PATH_STRATEGY_H_
 #define PATH_STRATEGY_H_
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 #include "IStrategy.h"
+#include "graph.h"
 
 /**
  * @brief this class inherits from the IStrategy class and is represents
@@ -11,16 +16,84 @@ class PathStrategy : public IStrategy {
  protected:
   /**
    * @brief a vector of all of the vector nodes
-   * for the current strategy path
+   * for the current strategy path, shared with the graph's route cache
+   */
+  routing::SharedPath path;
+
+  /**
+   * @brief indices into path of the vertices the entity steers toward,
+   * without the ones that barely bend the route
    */
-  std::vector<std::vector<float>> path;
+  std::vector<uint32_t> waypoints;
 
   /**
-   * @brief is the index
+   * @brief is the index into waypoints
    */
   int index;
 
+  /**
+   * @brief the graph the path was routed on, nullptr for a fixed path
+   */
+  const routing::IGraph *graph = nullptr;
+
+  /**
+   * @brief the strategy that routed the path
+   */
+  const routing::RoutingStrategy *router = nullptr;
+
+  /**
+   * @brief the graph version the path is current for
+   */
+  uint64_t version = 0;
+
+  /**
+   * @brief how the route query ended
+   */
+  routing::RouteStatus status = routing::RouteStatus::kFound;
+
+  /**
+   * @brief Start following a new path from its first waypoint
+   *
+   * @param path the shared path to follow
+   */
+  void SetPath(routing::SharedPath path);
+
+  /**
+   * @brief Route between two positions and follow the result. A search
+   * that runs out of kRouteBudgetNodes leaves a partial route that ends with
+   * a straight line to end. When edges change, the rest of the route is
+   * repaired instead of routed again.
+   *
+   * @param graph the graph to route on
+   * @param start the start position
+   * @param end the end position
+   * @param strategy the routing strategy, which must outlive this
+   */
+  void SetPath(const routing::IGraph *graph, std::vector<float> start,
+               std::vector<float> end,
+               const routing::RoutingStrategy &strategy);
+
+  /**
+   * @brief Reroute the part of the path ahead around the edges changed
+   * since version. Keeps the old path if there is no way around.
+   */
+  void Repair();
+
  public:
+  /**
+   * @brief how far the simplified route may stray from the road, well
+   * below the 4 unit arrival threshold
+   */
+  static constexpr float kSimplifyTolerance = 1.0f;
+
+  /**
+   * @brief how many nodes a route query may settle, so that a pathological
+   * trip cannot stall a whole simulation tick. A node count rather than a
+   * time keeps routes independent of machine load; 50000 nodes take a few
+   * milliseconds, ten times the campus map.
+   */
+  static constexpr uint32_t kRouteBudgetNodes = 50000;
+
   /**
    * @brief Construct a new PathStrategy Strategy object
    *
@@ -29,7 +102,15 @@ class PathStrategy : public IStrategy {
   explicit PathStrategy(std::vector<std::vector<float>> path = {});
 
   /**
-   * @brief Move toward next position in the path
+   * @brief Construct a new PathStrategy Strategy object
+   *
+   * @param path the shared path to follow
+   */
+  explicit PathStrategy(routing::SharedPath path);
+
+  /**
+   * @brief Move toward next position in the path, after repairing it if
+   * the graph changed
    *
    * @param entity Entity to move
    * @param dt Delta Time
@@ -43,6 +124,13 @@ class PathStrategy : public IStrategy {
    * @return True if complete, false if not complete
    */
   bool IsCompleted() override;
+
+  /**
+   * @brief Get how the route query ended
+   *
+   * @return kFound unless the route is partial or the end is unreachable
+   */
+  routing::RouteStatus GetRouteStatus() const { return status; }
 };
 
 #endif  // PATH_STRATEGY_H_
@@ -5,6 +5,7 @@
 
 #include "AstarStrategy.h"
 #include "BeelineStrategy.h"
+#include "BidirectionalStrategy.h"
 #include "DfsStrategy.h"
 #include "DijkstraStrategy.h"
 #include "JumpDecorator.h"
@@ -64,6 +65,9 @@ void Drone::GetNearestEntity(const std::vector<IEntity *> &scheduler) {
     else if (strategy_name == "dijkstra")
       toFinalDestination = new JumpDecorator(new SpinDecorator(
           new DijkstraStrategy(destination, finalDestination, graph)));
+    else if (strategy_name == "bidirectional")
+      toFinalDestination = new SpinDecorator(
+          new BidirectionalStrategy(destination, finalDestination, graph));
     else
       toFinalDestination = new BeelineStrategy(destination, finalDestination);
   }
@@ -3,9 +3,7 @@
 #include "BeelineStrategy.h"
 #include "ChargingStationRegistry.h"
 #include "Robot.h"
-#include "routing/astar.h"
 #include "routing/depth_first_search.h"
-#include "routing/dijkstra.h"
 #include "routing_api.h"
 
 ElectricDrone::ElectricDrone(Drone *drone) : DroneDeco(drone) {
@@ -210,51 +208,34 @@ bool ElectricDrone::IsCurrentTripPossible(
   std::vector<float> robot_destination_position = {
       robot_destination[0], robot_destination[1], robot_destination[2]};
 
-  std::vector<float> start =
-      graph->NearestNode(robot_beginning_position, EuclideanDistance())
-          ->GetPosition();
-  std::vector<float> end =
-      graph->NearestNode(robot_destination_position, EuclideanDistance())
-          ->GetPosition();
-
-  std::vector<std::vector<float>> pathB;
-  if (strategy_name == "dfs")
-    pathB = graph->GetPath(start, end, DepthFirstSearch::Default());
-  else if (strategy_name == "dijkstra")
-    pathB = graph->GetPath(start, end, Dijkstra::Default());
-  else if (strategy_name == "astar")
-    pathB = graph->GetPath(start, end, AStar::Default());
-  else
-    throw std::runtime_error("unrecognized strategy name");
-
-  // std::cout << "Path size: " << pathB.size() << std::endl;
-
+  // both queries below snap these to the nearest graph node themselves, so
+  // there is no need to look the nodes up here first
+  //
+  // routes of the shortest path strategies are as long as the network
+  // distance, which the distance matrix gives without building a path
   float robotOrigToRobotDest = 0;
-  float timeB = 0;
-  float depletionB = 0;
-
-  // // calculate the path's distance
-  for (int index = 0; index < pathB.size() - 1; ++index) {
-    // std::cout << "index: " << index << std::endl;
-    Vector3 node(pathB[index][0], pathB[index][1], pathB[index][2]);
-    Vector3 nextNode(pathB[index + 1][0], pathB[index + 1][1],
-                     pathB[index + 1][2]);
-
-    // update distance
-    robotOrigToRobotDest += node.Distance(nextNode);
-
-    // update incremental time for this mini segment between nodes
-    timeB += node.Distance(nextNode) / host_drone->GetSpeed();
-
-    // update incremental est. depletion for this mini segment
-    depletionB +=
-        (node.Distance(nextNode) / host_drone->GetSpeed()) * depletionRate;
-
-    if (battery * efficiency <= depletionA + depletionB + depletionC) {
-      return false;
+  if (strategy_name == "dfs") {
+    routing::SharedPath pathB =
+        graph->GetSharedPath(robot_beginning_position,
+                             robot_destination_position,
+                             DepthFirstSearch::Default());
+    for (int index = 0; index + 1 < pathB->size(); ++index) {
+      Vector3 node((*pathB)[index][0], (*pathB)[index][1], (*pathB)[index][2]);
+      Vector3 nextNode((*pathB)[index + 1][0], (*pathB)[index + 1][1],
+                       (*pathB)[index + 1][2]);
+      robotOrigToRobotDest += node.Distance(nextNode);
     }
+  } else if (strategy_name == "dijkstra" || strategy_name == "astar" ||
+             strategy_name == "bidirectional") {
+    robotOrigToRobotDest = graph->GetDistanceMatrix(
+        {robot_beginning_position}, {robot_destination_position})[0][0];
+  } else {
+    throw std::runtime_error("unrecognized strategy name");
   }
 
+  const float timeB = robotOrigToRobotDest / host_drone->GetSpeed();
+  const float depletionB = timeB * depletionRate;
+
   // std::cout << "robot path distance: " << robotOrigToRobotDest << std::endl;
   // std::cout << "robot path depletion: " << depletionB << std::endl;
   // std::cout << "robot path time: " << timeB << std::endl << std::endl;
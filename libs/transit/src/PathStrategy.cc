@@ -1,14 +1,62 @@
 #include "PathStrategy.h"
 
+#include <algorithm>
 #include <utility>
 
-PathStrategy::PathStrategy(std::vector<std::vector<float>> p)
-    : path(std::move(p)), index(0) {}
+#include "util/polyline.h"
+
+PathStrategy::PathStrategy(std::vector<std::vector<float>> p) : index(0) {
+  SetPath(std::make_shared<const std::vector<std::vector<float>>>(
+      std::move(p)));
+}
+
+PathStrategy::PathStrategy(routing::SharedPath p) : index(0) {
+  SetPath(std::move(p));
+}
+
+void PathStrategy::SetPath(routing::SharedPath p) {
+  path = std::move(p);
+  waypoints = routing::Polyline::SimplifyIndices(*path, kSimplifyTolerance);
+  index = 0;
+}
+
+void PathStrategy::SetPath(const routing::IGraph *g, std::vector<float> start,
+                           std::vector<float> end,
+                           const routing::RoutingStrategy &strategy) {
+  // read first, so a change during the search triggers a repair
+  const uint64_t current = g->GetVersion();
+  routing::SearchBudget budget;
+  budget.maxSettled = kRouteBudgetNodes;
+  SetPath(g->GetSharedPath(std::move(start), std::move(end), strategy, budget,
+                           &status));
+  graph = g;
+  router = &strategy;
+  version = current;
+}
+
+void PathStrategy::Repair() {
+  const uint64_t current = graph->GetVersion();
+  // the entity is past this vertex, on its way to waypoints[index]
+  const uint32_t passed = index > 0 ? waypoints[index - 1] : 0;
+  routing::SharedPath repaired =
+      graph->RepairPath(path, passed, version, *router);
+  version = current;
+  if (!repaired || repaired == path) return;
+
+  path = std::move(repaired);
+  waypoints = routing::Polyline::SimplifyIndices(*path, kSimplifyTolerance);
+  if (index > 0) {
+    index = std::upper_bound(waypoints.begin(), waypoints.end(), passed) -
+            waypoints.begin();
+  }
+}
 
 void PathStrategy::Move(IEntity *entity, double dt) {
   if (IsCompleted()) return;
+  if (graph && graph->GetVersion() != version) Repair();
 
-  Vector3 vi(path[index][0], path[index][1], path[index][2]);
+  const std::vector<float> &node = (*path)[waypoints[index]];
+  Vector3 vi(node[0], node[1], node[2]);
   Vector3 dir = (vi - entity->GetPosition()).Unit();
 
   entity->SetPosition(
@@ -20,4 +68,4 @@ void PathStrategy::Move(IEntity *entity, double dt) {
     index++;
 }
 
-bool PathStrategy::IsCompleted() { return index >= path.size(); }
+bool PathStrategy::IsCompleted() { return index >= waypoints.size(); }